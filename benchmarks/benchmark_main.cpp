@@ -0,0 +1,108 @@
+#include "benchmark_utils.hpp"
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<std::size_t> allocations{0};
+std::atomic<std::size_t> allocatedBytes{0};
+QThread*                 worker = nullptr;
+
+auto counted_malloc(std::size_t size) -> void* {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	if (auto* const pointer = std::malloc(size == 0 ? 1 : size)) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+auto counted_aligned_alloc(std::size_t size, std::align_val_t alignment)
+    -> void* {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	const auto align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+	auto* const pointer = _aligned_malloc(std::max<std::size_t>(size, 1), align);
+#else
+	// aligned_alloc requires a multiple of the alignment
+	const auto rounded =
+	    (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+	auto* const pointer = std::aligned_alloc(align, rounded);
+#endif
+	if (pointer == nullptr) {
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+void aligned_free(void* pointer) noexcept {
+#ifdef _WIN32
+	_aligned_free(pointer);
+#else
+	std::free(pointer);
+#endif
+}
+} // namespace
+
+// The array and nothrow forms forward to these by default
+auto operator new(std::size_t size) -> void* { return counted_malloc(size); }
+
+auto operator new(std::size_t size, std::align_val_t alignment) -> void* {
+	return counted_aligned_alloc(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::size_t /*size*/) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t /*alignment*/) noexcept {
+	aligned_free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t /*size*/,
+                     std::align_val_t /*alignment*/) noexcept {
+	aligned_free(pointer);
+}
+
+namespace stdexecutils::qt::benchmarks {
+
+auto allocation_count() noexcept -> std::size_t {
+	return allocations.load(std::memory_order_relaxed);
+}
+
+auto allocated_bytes() noexcept -> std::size_t {
+	return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+auto worker_thread() noexcept -> QThread* { return worker; }
+
+} // namespace stdexecutils::qt::benchmarks
+
+int main(int argc, char** argv) {
+	// Google Benchmark removes its flags before Qt sees the arguments
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+		return 1;
+	}
+
+	QCoreApplication application(argc, argv);
+
+	QThread workerThread;
+	workerThread.start();
+	worker = &workerThread;
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	workerThread.quit();
+	workerThread.wait();
+	return 0;
+}
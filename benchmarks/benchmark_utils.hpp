@@ -0,0 +1,215 @@
+#ifndef STDEXEC_UTILS_BENCHMARKS_BENCHMARK_UTILS_HPP
+#define STDEXEC_UTILS_BENCHMARKS_BENCHMARK_UTILS_HPP
+
+#include <benchmark/benchmark.h>
+
+#include <QCoreApplication>
+#include <QThread>
+
+#ifndef Q_MOC_RUN
+#include <stdexec/execution.hpp>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace stdexecutils::qt::benchmarks {
+
+using clock = std::chrono::steady_clock;
+
+// Heap allocations of the process so far, counted by the global operator new
+// of benchmark_main.cpp
+auto allocation_count() noexcept -> std::size_t;
+
+// Bytes requested from the global operator new so far, frees are not
+// subtracted
+auto allocated_bytes() noexcept -> std::size_t;
+
+// Thread with a running event loop, shared by the cross-thread benchmarks
+auto worker_thread() noexcept -> QThread*;
+
+// Runs the event loop of the calling thread until done() returns true
+template <class Done>
+void process_events_until(Done&& done) {
+	while (!done()) {
+		QCoreApplication::processEvents();
+	}
+}
+
+// Keeps the CPU busy for a short while, the work of background tasks
+struct busy_work {
+	void operator()() const noexcept {
+		const auto end = clock::now() + std::chrono::microseconds{2};
+		while (clock::now() < end) {
+		}
+	}
+};
+
+// Counts completions down, the last one records its time and wakes wait()
+class completion_latch {
+public:
+	explicit completion_latch(std::size_t count = 1) noexcept : m_count(count) {}
+
+	completion_latch(const completion_latch&) = delete;
+	completion_latch(completion_latch&&)      = delete;
+
+	void reset(std::size_t count) noexcept {
+		m_count.store(count, std::memory_order_relaxed);
+		m_done.store(false, std::memory_order_relaxed);
+	}
+
+	void count_down() noexcept {
+		if (m_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			m_completedAt = clock::now();
+			m_done.store(true, std::memory_order_release);
+			m_done.notify_one();
+		}
+	}
+
+	[[nodiscard]] auto done() const noexcept -> bool {
+		return m_done.load(std::memory_order_acquire);
+	}
+
+	void wait() const noexcept {
+		m_done.wait(false, std::memory_order_acquire);
+	}
+
+	[[nodiscard]] auto completed_at() const noexcept -> clock::time_point {
+		return m_completedAt;
+	}
+
+private:
+	std::atomic<std::size_t> m_count;
+	std::atomic<bool>        m_done{false};
+	clock::time_point        m_completedAt;
+};
+
+struct latch_receiver {
+	using receiver_concept = stdexec::receiver_t;
+
+	// Values of the sender are dropped
+	template <class... Values>
+	void set_value(Values&&... /*values*/) noexcept {
+		m_latch->count_down();
+	}
+
+	template <class Error>
+	void set_error(Error&& /*error*/) noexcept {
+		m_latch->count_down();
+	}
+
+	void set_stopped() noexcept { m_latch->count_down(); }
+
+	[[nodiscard]] auto get_env() const noexcept -> stdexec::empty_env {
+		return {};
+	}
+
+	completion_latch* m_latch;
+};
+
+// Operation state that is connected in place, so the benchmarks measure the
+// allocations of the schedulers only
+template <class Sender>
+struct operation {
+	operation(Sender sender, completion_latch& latch)
+	    : m_opState(stdexec::connect(std::move(sender), latch_receiver{&latch})) {
+	}
+
+	void start() noexcept { stdexec::start(m_opState); }
+
+	stdexec::connect_result_t<Sender, latch_receiver> m_opState;
+};
+
+// Storage for a burst of operations, allocated once and reused by every
+// iteration
+template <class MakeSender>
+class operation_batch {
+public:
+	using sender_type = std::invoke_result_t<MakeSender&>;
+
+	operation_batch(std::size_t size, MakeSender makeSender)
+	    : m_operations(
+	          std::make_unique<std::optional<operation<sender_type>>[]>(size)),
+	      m_size(size), m_makeSender(std::move(makeSender)) {}
+
+	[[nodiscard]] auto size() const noexcept -> std::size_t { return m_size; }
+
+	// The operations of the previous start must have completed
+	void start(completion_latch& latch) {
+		for (std::size_t i = 0; i < m_size; ++i) {
+			m_operations[i].reset();
+			m_operations[i].emplace(m_makeSender(), latch);
+			m_operations[i]->start();
+		}
+	}
+
+private:
+	std::unique_ptr<std::optional<operation<sender_type>>[]> m_operations;
+	std::size_t                                              m_size;
+	MakeSender                                               m_makeSender;
+};
+
+// Reports the heap allocations and their bytes since construction per
+// operation
+class allocation_counter {
+public:
+	allocation_counter() noexcept
+	    : m_start(allocation_count()), m_startBytes(allocated_bytes()) {}
+
+	void report(benchmark::State& state, std::size_t operations,
+	            const char* unit = "op") const {
+		const auto perOperation = [operations](std::size_t count) {
+			return operations == 0 ? 0.0
+			                       : static_cast<double>(count) /
+			                             static_cast<double>(operations);
+		};
+		state.counters[std::string("allocs_per_") + unit] =
+		    perOperation(allocation_count() - m_start);
+		state.counters[std::string("bytes_per_") + unit] =
+		    perOperation(allocated_bytes() - m_startBytes);
+	}
+
+private:
+	std::size_t m_start;
+	std::size_t m_startBytes;
+};
+
+// Collects latency samples and reports their percentiles in microseconds
+class latency_recorder {
+public:
+	explicit latency_recorder(std::size_t expectedSamples) {
+		m_samples.reserve(expectedSamples);
+	}
+
+	void add(clock::duration sample) { m_samples.push_back(sample); }
+
+	void report(benchmark::State& state) {
+		if (m_samples.empty()) {
+			return;
+		}
+		std::sort(m_samples.begin(), m_samples.end());
+		const auto percentile = [this](double fraction) {
+			const auto index = static_cast<std::size_t>(
+			    fraction * static_cast<double>(m_samples.size() - 1));
+			return std::chrono::duration<double, std::micro>(m_samples[index])
+			    .count();
+		};
+		state.counters["p50_us"] = percentile(0.5);
+		state.counters["p99_us"] = percentile(0.99);
+		state.counters["max_us"] = percentile(1.0);
+	}
+
+private:
+	std::vector<clock::duration> m_samples;
+};
+
+} // namespace stdexecutils::qt::benchmarks
+
+#endif // STDEXEC_UTILS_BENCHMARKS_BENCHMARK_UTILS_HPP
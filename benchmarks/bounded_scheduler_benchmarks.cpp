@@ -0,0 +1,188 @@
+#include "benchmark_utils.hpp"
+
+#include <stdexecutils/qt/bounded_scheduler.hpp>
+#include <stdexecutils/qt/qthreadpool_scheduler.hpp>
+
+#include <QThreadPool>
+
+#ifndef Q_MOC_RUN
+#include <exec/async_scope.hpp>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#if defined(__linux__) && defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace stdexecutils::qt;
+using namespace stdexecutils::qt::benchmarks;
+
+namespace {
+
+constexpr std::size_t submissions = 100'000;
+
+using payload = std::array<std::byte, 1024>;
+
+// bounded() limits how many submissions are queued on the pool at a time. It
+// saves memory only if the producer creates the state of a submission once
+// it got admitted: submissions that are spawned up front keep their captured
+// state while they are parked.
+
+#ifdef __linux__
+// Resets the peak resident set size of the process, Linux 4.0 and later.
+// Memory that the allocator kept from earlier benchmarks is returned first,
+// it would count towards the peak otherwise.
+void reset_peak_rss() {
+#ifdef __GLIBC__
+	malloc_trim(0);
+#endif
+	std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+// Peak resident set size since the last reset, VmHWM of /proc/self/status
+auto peak_rss_bytes() -> std::size_t {
+	std::ifstream status("/proc/self/status");
+	std::string   line;
+	while (std::getline(status, line)) {
+		if (line.rfind("VmHWM:", 0) == 0) {
+			return std::stoul(line.substr(6)) * 1024;
+		}
+	}
+	return 0;
+}
+#else
+void reset_peak_rss() {}
+
+auto peak_rss_bytes() -> std::size_t { return 0; }
+#endif
+
+// Spawns all submissions at once, each with 1 KiB of captured state, and
+// waits until they ran
+template <class Scheduler>
+void submit_all(Scheduler& scheduler) {
+	exec::async_scope scope;
+	for (std::size_t i = 0; i < submissions; ++i) {
+		scope.spawn(stdexec::schedule(scheduler) |
+		            stdexec::then([state = payload{}]() {
+			            benchmark::DoNotOptimize(state);
+			            busy_work{}();
+		            }));
+	}
+	stdexec::sync_wait(scope.on_empty());
+}
+
+// Back-pressured producer: keeps one submission per slot of the bounded
+// scheduler going. A submission creates its 1 KiB payload once bounded()
+// admitted it, and submits the next one when it is done.
+template <class Scheduler>
+class paced_producer {
+public:
+	paced_producer(Scheduler scheduler, std::size_t lanes)
+	    : m_scheduler(std::move(scheduler)), m_lanes(lanes) {}
+
+	void run() {
+		m_submitted.store(0, std::memory_order_relaxed);
+		exec::async_scope scope;
+		for (std::size_t i = 0; i < std::min(m_lanes, submissions); ++i) {
+			submit_next(scope);
+		}
+		stdexec::sync_wait(scope.on_empty());
+	}
+
+private:
+	// Spawned before the calling submission completes, so the scope doesn't
+	// become empty in between
+	void submit_next(exec::async_scope& scope) {
+		if (m_submitted.fetch_add(1, std::memory_order_relaxed) >= submissions) {
+			return;
+		}
+		scope.spawn(stdexec::schedule(m_scheduler) |
+		            stdexec::then([this, &scope]() {
+			            const auto state = std::make_unique<payload>();
+			            benchmark::DoNotOptimize(state.get());
+			            busy_work{}();
+			            submit_next(scope);
+		            }));
+	}
+
+	Scheduler                m_scheduler;
+	const std::size_t        m_lanes;
+	std::atomic<std::size_t> m_submitted{0};
+};
+
+template <class Scheduler>
+void report(benchmark::State& state, const Scheduler& scheduler,
+            std::size_t peakRss) {
+	state.SetItemsProcessed(
+	    static_cast<std::int64_t>(state.iterations() * submissions));
+	state.counters["peak_queued"] =
+	    static_cast<double>(scheduler.metrics().peakPending);
+	state.counters["peak_rss_mb"] =
+	    static_cast<double>(peakRss) / (1024.0 * 1024.0);
+}
+
+// 100k submissions straight to the pool, they are all queued at once with
+// their payloads
+void BM_Unbounded_Submit(benchmark::State& state) {
+	QThreadPool pool;
+	auto        scheduler = qthread_scheduler(&pool);
+	scheduler.enable_metrics();
+	reset_peak_rss();
+	for (auto _ : state) {
+		submit_all(scheduler);
+	}
+	report(state, scheduler, peak_rss_bytes());
+}
+BENCHMARK(BM_Unbounded_Submit)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// The same submissions through bounded() with Arg slots, the others wait
+// parked in their operation states, which still hold their payloads
+void BM_Bounded_Submit(benchmark::State& state) {
+	const auto  maxInFlight = static_cast<std::size_t>(state.range(0));
+	QThreadPool pool;
+	auto        inner     = qthread_scheduler(&pool);
+	auto        scheduler = bounded(inner, maxInFlight);
+	inner.enable_metrics();
+	reset_peak_rss();
+	for (auto _ : state) {
+		submit_all(scheduler);
+	}
+	report(state, inner, peak_rss_bytes());
+}
+BENCHMARK(BM_Bounded_Submit)
+    ->ArgName("max_in_flight")
+    ->RangeMultiplier(8)
+    ->Range(8, 512)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// The same submissions from the back-pressured producer, at most Arg
+// payloads exist at a time
+void BM_Bounded_PacedSubmit(benchmark::State& state) {
+	const auto  maxInFlight = static_cast<std::size_t>(state.range(0));
+	QThreadPool pool;
+	auto        inner = qthread_scheduler(&pool);
+	inner.enable_metrics();
+	paced_producer producer(bounded(inner, maxInFlight), maxInFlight);
+	reset_peak_rss();
+	for (auto _ : state) {
+		producer.run();
+	}
+	report(state, inner, peak_rss_bytes());
+}
+BENCHMARK(BM_Bounded_PacedSubmit)
+    ->ArgName("max_in_flight")
+    ->RangeMultiplier(8)
+    ->Range(8, 512)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
@@ -0,0 +1,136 @@
+#include "benchmark_utils.hpp"
+
+#include <stdexecutils/qt/mapped_file.hpp>
+#include <stdexecutils/qt/qthreadpool_scheduler.hpp>
+
+#include <QByteArray>
+#include <QFile>
+#include <QTemporaryFile>
+#include <QThreadPool>
+
+#ifndef Q_MOC_RUN
+#include <exec/sequence/ignore_all_values.hpp>
+#include <exec/sequence/transform_each.hpp>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+using namespace stdexecutils::qt;
+using namespace stdexecutils::qt::benchmarks;
+
+namespace {
+
+constexpr std::size_t file_size  = std::size_t{256} << 20;
+constexpr std::size_t chunk_size = std::size_t{1} << 20;
+constexpr std::size_t chunk_count =
+    (file_size + chunk_size - 1) / chunk_size;
+
+// File shared by the benchmarks, it is in the page cache after the first run
+auto test_file() -> const QString& {
+	static const auto file = []() {
+		auto temporary = std::make_unique<QTemporaryFile>();
+		temporary->open();
+		const QByteArray block(1 << 20, 'x');
+		for (std::size_t written = 0; written < file_size;
+		     written += static_cast<std::size_t>(block.size())) {
+			temporary->write(block);
+		}
+		temporary->flush();
+		return temporary;
+	}();
+	static const auto name = file->fileName();
+	return name;
+}
+
+// The parsing work of a chunk
+auto checksum(std::span<const std::byte> data) noexcept -> std::uint64_t {
+	std::uint64_t sum = 0;
+	for (const auto byte : data) {
+		sum += std::to_integer<std::uint64_t>(byte);
+	}
+	return sum;
+}
+
+// Maps the file and checksums its chunks in parallel, results in file order
+void BM_MappedFile_Transform(benchmark::State& state) {
+	QThreadPool pool;
+	const auto  scheduler = qthread_scheduler(&pool);
+	const auto& path      = test_file();
+	for (auto _ : state) {
+		auto result = stdexec::sync_wait(transform_mapped_file(
+		    scheduler, path, chunk_size,
+		    [](const file_chunk& chunk) { return checksum(chunk.data); }));
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+	                        static_cast<std::int64_t>(file_size));
+}
+BENCHMARK(BM_MappedFile_Transform)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// The chunks as a sequence, also reports the time until the first chunk
+void BM_MappedFile_Chunks(benchmark::State& state) {
+	QThreadPool                pool;
+	const auto                 scheduler = qthread_scheduler(&pool);
+	const auto&                path      = test_file();
+	std::atomic<std::uint64_t> sum{0};
+	clock::duration            firstChunk{};
+	for (auto _ : state) {
+		const auto        start = clock::now();
+		std::atomic<bool> first{true};
+		stdexec::sync_wait(exec::ignore_all_values(exec::transform_each(
+		    mapped_file_chunks(scheduler, path, chunk_size),
+		    stdexec::then([&](file_chunk chunk) {
+			    if (first.exchange(false, std::memory_order_relaxed)) {
+				    firstChunk += clock::now() - start;
+			    }
+			    sum.fetch_add(checksum(chunk.data), std::memory_order_relaxed);
+		    }))));
+	}
+	benchmark::DoNotOptimize(sum.load());
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+	                        static_cast<std::int64_t>(file_size));
+	state.counters["first_chunk_us"] =
+	    std::chrono::duration<double, std::micro>(firstChunk).count() /
+	    static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_MappedFile_Chunks)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Baseline: the file is read into one QByteArray, then checksummed in
+// parallel. Nothing can start before the whole file is read.
+void BM_ReadAll_Transform(benchmark::State& state) {
+	QThreadPool pool;
+	const auto  scheduler = qthread_scheduler(&pool);
+	const auto& path      = test_file();
+	for (auto _ : state) {
+		std::vector<std::uint64_t> sums(chunk_count);
+		stdexec::sync_wait(
+		    stdexec::schedule(scheduler) | stdexec::then([&path]() {
+			    QFile file(path);
+			    file.open(QIODevice::ReadOnly);
+			    return file.readAll();
+		    }) |
+		    stdexec::bulk(chunk_count, [&sums](std::size_t index,
+		                                       const QByteArray& data) {
+			    const auto offset = index * chunk_size;
+			    const auto size =
+			        std::min(chunk_size, static_cast<std::size_t>(data.size()) - offset);
+			    sums[index] = checksum(std::as_bytes(
+			        std::span(data.constData() + offset, size)));
+		    }));
+		benchmark::DoNotOptimize(sums.data());
+	}
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+	                        static_cast<std::int64_t>(file_size));
+}
+BENCHMARK(BM_ReadAll_Transform)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace
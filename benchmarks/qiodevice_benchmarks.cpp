@@ -0,0 +1,100 @@
+#include "benchmark_utils.hpp"
+
+#include <stdexecutils/qt/qiodevice.hpp>
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+using namespace stdexecutils::qt;
+using namespace stdexecutils::qt::benchmarks;
+
+namespace {
+
+// Connected pair of local sockets on the calling thread
+struct local_socket_pair {
+	local_socket_pair() {
+		const auto name = QStringLiteral("stdexecutils-benchmark-%1")
+		                      .arg(QCoreApplication::applicationPid());
+		QLocalServer::removeServer(name);
+		server.listen(name);
+		client.connectToServer(name);
+		client.waitForConnected();
+		server.waitForNewConnection(1000);
+		peer = server.nextPendingConnection();
+	}
+
+	QLocalServer  server;
+	QLocalSocket  client;
+	QLocalSocket* peer{nullptr};
+};
+
+// Chunks of Arg bytes written to one end of a local socket pair and read
+// into a preallocated buffer at the other end
+void BM_LocalSocket_WriteReadExact(benchmark::State& state) {
+	local_socket_pair sockets;
+	if (sockets.peer == nullptr) {
+		state.SkipWithError("local sockets not connected");
+		return;
+	}
+	const auto             size = static_cast<std::size_t>(state.range(0));
+	std::vector<std::byte> data(size, std::byte{42});
+	std::vector<std::byte> received(size);
+	completion_latch       latch;
+
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(2);
+		operation writeOp(async_write(&sockets.client, data), latch);
+		operation readOp(async_read_exact(sockets.peer, received), latch);
+		writeOp.start();
+		readOp.start();
+		process_events_until([&]() { return latch.done(); });
+	}
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+	                        static_cast<std::int64_t>(size));
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_LocalSocket_WriteReadExact)->Arg(256)->Arg(64 << 10)->Arg(1 << 20);
+
+// Reads whatever arrived with async_read_some until Arg bytes are in
+void BM_LocalSocket_ReadSome(benchmark::State& state) {
+	local_socket_pair sockets;
+	if (sockets.peer == nullptr) {
+		state.SkipWithError("local sockets not connected");
+		return;
+	}
+	const auto             size = static_cast<std::size_t>(state.range(0));
+	std::vector<std::byte> data(size, std::byte{42});
+	std::vector<std::byte> received(size);
+	completion_latch       latch;
+
+	for (auto _ : state) {
+		sockets.client.write(reinterpret_cast<const char*>(data.data()),
+		                     static_cast<qint64>(size));
+		std::size_t total = 0;
+		while (total < size) {
+			latch.reset(1);
+			std::size_t count = 0;
+			operation   op(async_read_some(sockets.peer,
+			                               std::span(received).subspan(total)) |
+			                   stdexec::then([&count](std::size_t read) {
+				                   count = read;
+			                   }),
+			               latch);
+			op.start();
+			process_events_until([&]() { return latch.done(); });
+			total += count;
+		}
+	}
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+	                        static_cast<std::int64_t>(size));
+}
+BENCHMARK(BM_LocalSocket_ReadSome)->Arg(64 << 10)->Arg(1 << 20);
+
+} // namespace
@@ -0,0 +1,109 @@
+#include "benchmark_utils.hpp"
+
+#include <stdexecutils/qt/qml_receiver.hpp>
+#include <stdexecutils/qt/qthread_scheduler.hpp>
+
+#include <QByteArray>
+#include <QJSEngine>
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+using namespace stdexecutils::qt;
+using namespace stdexecutils::qt::benchmarks;
+
+namespace {
+
+// Engine with a JS handler that counts its calls
+class counting_engine {
+public:
+	counting_engine() {
+		m_engine.globalObject().setProperty("completed", 0);
+		m_handler = m_engine.evaluate("(function() { ++completed; })");
+	}
+
+	// Hands the receiver to the engine and attaches the handler, the caller
+	// deletes it
+	void attach(QmlReceiver* receiver) {
+		QJSEngine::setObjectOwnership(receiver, QJSEngine::CppOwnership);
+		m_engine.newQObject(receiver);
+		receiver->then(m_handler);
+		++m_expected;
+	}
+
+	void wait_for_handler() {
+		process_events_until([this]() {
+			return m_engine.globalObject().property("completed").toInt() ==
+			       m_expected;
+		});
+	}
+
+private:
+	QJSEngine m_engine;
+	QJSValue  m_handler;
+	int       m_expected{0};
+};
+
+// Launch of a QmlReceiver until its JS handler ran, the sender completes on
+// the thread of the receiver. Arg selects the queued or the immediate mode.
+void BM_QmlReceiver_LaunchToCallback(benchmark::State& state) {
+	counting_engine          engine;
+	const QThreadScheduler   scheduler(QThread::currentThread());
+	const bool               immediate = state.range(0) != 0;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		auto* const receiver =
+		    immediate ? new QmlReceiver(QmlReceiver::immediate_completion,
+		                                stdexec::schedule(scheduler))
+		              : new QmlReceiver(stdexec::schedule(scheduler));
+		engine.attach(receiver);
+		engine.wait_for_handler();
+		delete receiver;
+	}
+	state.SetItemsProcessed(state.iterations());
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_QmlReceiver_LaunchToCallback)
+    ->ArgName("immediate")
+    ->Arg(0)
+    ->Arg(1);
+
+template <class Payload>
+auto make_payload(std::size_t bytes) -> Payload {
+	if constexpr (std::is_same_v<Payload, QByteArray>) {
+		return QByteArray(static_cast<qsizetype>(bytes), 'x');
+	} else {
+		return Payload(bytes / sizeof(typename Payload::value_type));
+	}
+}
+
+// Result of Arg bytes handed to JS: a float vector is copied into a typed
+// array, a QByteArray is shared with its ArrayBuffer
+template <class Payload>
+void BM_QmlReceiver_Payload(benchmark::State& state) {
+	counting_engine engine;
+	const auto      bytes   = static_cast<std::size_t>(state.range(0));
+	const auto      payload = make_payload<Payload>(bytes);
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto result = payload;
+		state.ResumeTiming();
+		auto* const receiver = new QmlReceiver(stdexec::just(std::move(result)));
+		engine.attach(receiver);
+		engine.wait_for_handler();
+		delete receiver;
+	}
+	state.SetBytesProcessed(state.iterations() *
+	                        static_cast<std::int64_t>(bytes));
+}
+BENCHMARK_TEMPLATE(BM_QmlReceiver_Payload, std::vector<float>)
+    ->ArgName("bytes")
+    ->RangeMultiplier(10)
+    ->Range(1 << 10, 10 << 20);
+BENCHMARK_TEMPLATE(BM_QmlReceiver_Payload, QByteArray)
+    ->ArgName("bytes")
+    ->RangeMultiplier(10)
+    ->Range(1 << 10, 10 << 20);
+
+} // namespace
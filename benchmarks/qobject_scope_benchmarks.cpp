@@ -0,0 +1,74 @@
+#include "benchmark_utils.hpp"
+
+#include <stdexecutils/qt/qobject_scope.hpp>
+#include <stdexecutils/qt/qthread_scheduler.hpp>
+
+#include <QObject>
+
+#ifndef Q_MOC_RUN
+#include <exec/async_scope.hpp>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace stdexecutils::qt;
+using namespace stdexecutils::qt::benchmarks;
+
+namespace {
+
+constexpr std::size_t burst_size = 1000;
+
+// Spawns a burst of schedule() onto the current thread and drains it, the
+// arena of the scope is rewound after every burst
+void BM_QObjectScope_Spawn(benchmark::State& state) {
+	const QThreadScheduler scheduler(QThread::currentThread());
+	QObject                object;
+	QObjectScope           scope(&object);
+	completion_latch       latch;
+	// The first burst grows the arena
+	latch.reset(burst_size);
+	for (std::size_t i = 0; i < burst_size; ++i) {
+		scope.spawn(stdexec::schedule(scheduler) |
+		            stdexec::then([&latch]() noexcept { latch.count_down(); }));
+	}
+	process_events_until([&]() { return latch.done(); });
+
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(burst_size);
+		for (std::size_t i = 0; i < burst_size; ++i) {
+			scope.spawn(stdexec::schedule(scheduler) |
+			            stdexec::then([&latch]() noexcept { latch.count_down(); }));
+		}
+		process_events_until([&]() { return scope.active() == 0; });
+	}
+	const auto operations = state.iterations() * burst_size;
+	state.SetItemsProcessed(static_cast<std::int64_t>(operations));
+	allocations.report(state, operations);
+}
+BENCHMARK(BM_QObjectScope_Spawn);
+
+// The same bursts with exec::async_scope, which allocates every spawned
+// operation state
+void BM_AsyncScope_Spawn(benchmark::State& state) {
+	const QThreadScheduler   scheduler(QThread::currentThread());
+	exec::async_scope        scope;
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(burst_size);
+		for (std::size_t i = 0; i < burst_size; ++i) {
+			scope.spawn(stdexec::schedule(scheduler) |
+			            stdexec::then([&latch]() noexcept { latch.count_down(); }));
+		}
+		process_events_until([&]() { return latch.done(); });
+	}
+	const auto operations = state.iterations() * burst_size;
+	state.SetItemsProcessed(static_cast<std::int64_t>(operations));
+	allocations.report(state, operations);
+	stdexec::sync_wait(scope.on_empty());
+}
+BENCHMARK(BM_AsyncScope_Spawn);
+
+} // namespace
@@ -0,0 +1,59 @@
+#include "benchmark_utils.hpp"
+
+#include <stdexecutils/qt/qthread_group.hpp>
+
+#include <cstdint>
+#include <utility>
+
+using namespace stdexecutils::qt;
+using namespace stdexecutils::qt::benchmarks;
+
+namespace {
+
+constexpr std::size_t burst_size = 10'000;
+
+// Bursts of short tasks scheduled from outside onto a group of Arg threads,
+// with schedule() or schedule_on_least_loaded()
+void BM_QThreadGroup_Throughput(benchmark::State& state) {
+	const QThreadGroup group(static_cast<int>(state.range(0)));
+	const auto         scheduler   = group.get_scheduler();
+	const bool         leastLoaded = state.range(1) != 0;
+	operation_batch    batch(burst_size, [&]() {
+		auto sender = leastLoaded ? scheduler.schedule_on_least_loaded()
+		                          : scheduler.schedule();
+		return std::move(sender) | stdexec::then(busy_work{});
+	});
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(batch.size());
+		batch.start(latch);
+		latch.wait();
+	}
+	const auto operations = state.iterations() * batch.size();
+	state.SetItemsProcessed(static_cast<std::int64_t>(operations));
+	allocations.report(state, operations);
+}
+BENCHMARK(BM_QThreadGroup_Throughput)
+    ->ArgNames({"threads", "least_loaded"})
+    ->ArgsProduct({{1, 2, 4, 8}, {0, 1}})
+    ->UseRealTime();
+
+// Round trip of one schedule() onto an idle group
+void BM_QThreadGroup_ScheduleLatency(benchmark::State& state) {
+	const QThreadGroup       group(4);
+	const auto               scheduler = group.get_scheduler();
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(1);
+		operation op(scheduler.schedule(), latch);
+		op.start();
+		latch.wait();
+	}
+	state.SetItemsProcessed(state.iterations());
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_QThreadGroup_ScheduleLatency)->UseRealTime();
+
+} // namespace
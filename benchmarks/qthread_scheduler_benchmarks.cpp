@@ -0,0 +1,544 @@
+#include "benchmark_utils.hpp"
+
+#include <stdexecutils/qt/detail/timer_wheel.hpp>
+#include <stdexecutils/qt/qthread_scheduler.hpp>
+
+#include <QBasicTimer>
+#include <QObject>
+
+#ifndef Q_MOC_RUN
+#include <exec/timed_scheduler.hpp>
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace stdexecutils::qt;
+using namespace stdexecutils::qt::benchmarks;
+
+namespace {
+
+constexpr std::size_t burst_size = 10'000;
+
+// Round trip of one schedule() onto the thread that starts it
+void BM_QThreadScheduler_ScheduleSameThread(benchmark::State& state) {
+	const QThreadScheduler   scheduler(QThread::currentThread());
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(1);
+		operation op(stdexec::schedule(scheduler), latch);
+		op.start();
+		process_events_until([&]() { return latch.done(); });
+	}
+	state.SetItemsProcessed(state.iterations());
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_QThreadScheduler_ScheduleSameThread);
+
+// Round trip of one schedule() onto another thread
+void BM_QThreadScheduler_ScheduleCrossThread(benchmark::State& state) {
+	const QThreadScheduler   scheduler(worker_thread());
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(1);
+		operation op(stdexec::schedule(scheduler), latch);
+		op.start();
+		latch.wait();
+	}
+	state.SetItemsProcessed(state.iterations());
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_QThreadScheduler_ScheduleCrossThread)->UseRealTime();
+
+// schedule() followed by continues_on the same scheduler, the transition
+// completes inline instead of taking a second event loop iteration
+void BM_QThreadScheduler_ContinuesOnSameThread(benchmark::State& state) {
+	const QThreadScheduler   scheduler(QThread::currentThread());
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(1);
+		operation op(stdexec::schedule(scheduler) |
+		                 stdexec::continues_on(scheduler),
+		             latch);
+		op.start();
+		process_events_until([&]() { return latch.done(); });
+	}
+	state.SetItemsProcessed(state.iterations());
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_QThreadScheduler_ContinuesOnSameThread);
+
+// Bursts of schedule() onto the thread that starts them
+void BM_QThreadScheduler_ThroughputSameThread(benchmark::State& state) {
+	const QThreadScheduler scheduler(QThread::currentThread());
+	operation_batch batch(burst_size,
+	                      [&]() { return stdexec::schedule(scheduler); });
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(batch.size());
+		batch.start(latch);
+		process_events_until([&]() { return latch.done(); });
+	}
+	const auto operations = state.iterations() * batch.size();
+	state.SetItemsProcessed(static_cast<std::int64_t>(operations));
+	allocations.report(state, operations);
+}
+BENCHMARK(BM_QThreadScheduler_ThroughputSameThread);
+
+// Bursts of schedule() from Arg producer threads onto one thread
+void BM_QThreadScheduler_ThroughputCrossThread(benchmark::State& state) {
+	const auto             producers = static_cast<std::size_t>(state.range(0));
+	const QThreadScheduler scheduler(worker_thread());
+	const auto makeSender = [&]() { return stdexec::schedule(scheduler); };
+
+	std::vector<operation_batch<decltype(makeSender)>> batches;
+	batches.reserve(producers);
+	for (std::size_t i = 0; i < producers; ++i) {
+		batches.emplace_back(burst_size, makeSender);
+	}
+	std::vector<std::thread> threads;
+	threads.reserve(producers);
+
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(producers * burst_size);
+		for (auto& batch : batches) {
+			threads.emplace_back([&]() { batch.start(latch); });
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		threads.clear();
+		latch.wait();
+	}
+	// Includes the allocation of the producer threads
+	const auto operations = state.iterations() * producers * burst_size;
+	state.SetItemsProcessed(static_cast<std::int64_t>(operations));
+	allocations.report(state, operations);
+}
+BENCHMARK(BM_QThreadScheduler_ThroughputCrossThread)
+    ->ArgName("producers")
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseRealTime();
+
+// Latency of one schedule() with the priority Arg while the thread drains
+// 1000 low priority tasks
+void BM_QThreadScheduler_PriorityLatency(benchmark::State& state) {
+	const QThreadScheduler background(worker_thread(), Qt::LowEventPriority);
+	const QThreadScheduler scheduler(
+	    worker_thread(), static_cast<Qt::EventPriority>(state.range(0)));
+	operation_batch load(1000, [&]() {
+		return stdexec::schedule(background) | stdexec::then(busy_work{});
+	});
+	completion_latch latch;
+	completion_latch loadLatch;
+	latency_recorder latencies(1 << 16);
+	for (auto _ : state) {
+		loadLatch.reset(load.size());
+		load.start(loadLatch);
+		latch.reset(1);
+		operation  op(stdexec::schedule(scheduler), latch);
+		const auto started = clock::now();
+		op.start();
+		latch.wait();
+		latencies.add(latch.completed_at() - started);
+		loadLatch.wait();
+	}
+	latencies.report(state);
+}
+BENCHMARK(BM_QThreadScheduler_PriorityLatency)
+    ->ArgName("priority")
+    ->Arg(Qt::LowEventPriority)
+    ->Arg(Qt::NormalEventPriority)
+    ->Arg(Qt::HighEventPriority)
+    ->UseRealTime();
+
+// Lateness of schedule_at with a 1 ms deadline and the timer type Arg
+void BM_QThreadScheduler_ScheduleAtJitter(benchmark::State& state) {
+	const QThreadScheduler scheduler(worker_thread(),
+	                                 static_cast<Qt::TimerType>(state.range(0)));
+	completion_latch       latch;
+	latency_recorder       lateness(1000);
+	for (auto _ : state) {
+		latch.reset(1);
+		const auto deadline = clock::now() + std::chrono::milliseconds{1};
+		operation  op(scheduler.schedule_at(deadline), latch);
+		op.start();
+		latch.wait();
+		lateness.add(latch.completed_at() - deadline);
+	}
+	lateness.report(state);
+}
+BENCHMARK(BM_QThreadScheduler_ScheduleAtJitter)
+    ->ArgName("timer_type")
+    ->Arg(Qt::PreciseTimer)
+    ->Arg(Qt::CoarseTimer)
+    ->Iterations(1000)
+    ->UseRealTime();
+
+// Event-loop thread that is woken with posted events, or with an eventfd
+// when eventfd is set
+class wakeup_thread {
+public:
+	explicit wakeup_thread(bool eventfd) {
+		m_thread.start();
+		m_supported =
+		    !eventfd || QThreadScheduler::enable_eventfd_wakeup(&m_thread);
+		// The switch is done on the thread, wait for it
+		stdexec::sync_wait(stdexec::schedule(scheduler()));
+	}
+
+	wakeup_thread(const wakeup_thread&) = delete;
+	wakeup_thread(wakeup_thread&&)      = delete;
+
+	~wakeup_thread() {
+		m_thread.quit();
+		m_thread.wait();
+	}
+
+	[[nodiscard]] auto supported() const noexcept -> bool { return m_supported; }
+
+	[[nodiscard]] auto scheduler() noexcept -> QThreadScheduler {
+		return QThreadScheduler(&m_thread);
+	}
+
+private:
+	QThread m_thread;
+	bool    m_supported{true};
+};
+
+// Round trip of one schedule() onto another thread that is woken as selected
+// by Arg: 0 for posted events, 1 for the eventfd
+void BM_QThreadScheduler_WakeupLatency(benchmark::State& state) {
+	wakeup_thread thread(state.range(0) != 0);
+	if (!thread.supported()) {
+		state.SkipWithError("eventfd wakeup is not supported");
+		return;
+	}
+	const auto               scheduler = thread.scheduler();
+	completion_latch         latch;
+	latency_recorder         latencies(1 << 16);
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(1);
+		operation  op(stdexec::schedule(scheduler), latch);
+		const auto started = clock::now();
+		op.start();
+		latch.wait();
+		latencies.add(latch.completed_at() - started);
+	}
+	state.SetItemsProcessed(state.iterations());
+	latencies.report(state);
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_QThreadScheduler_WakeupLatency)
+    ->ArgName("eventfd")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+
+// Bursts of Arg(1) schedule() onto another thread that is woken as selected
+// by Arg(0), small bursts wake the thread more often
+void BM_QThreadScheduler_WakeupThroughput(benchmark::State& state) {
+	wakeup_thread thread(state.range(0) != 0);
+	if (!thread.supported()) {
+		state.SkipWithError("eventfd wakeup is not supported");
+		return;
+	}
+	const auto      scheduler = thread.scheduler();
+	operation_batch batch(static_cast<std::size_t>(state.range(1)),
+	                      [&]() { return stdexec::schedule(scheduler); });
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(batch.size());
+		batch.start(latch);
+		latch.wait();
+	}
+	const auto operations = state.iterations() * batch.size();
+	state.SetItemsProcessed(static_cast<std::int64_t>(operations));
+	allocations.report(state, operations);
+}
+BENCHMARK(BM_QThreadScheduler_WakeupThroughput)
+    ->ArgNames({"eventfd", "burst"})
+    ->ArgsProduct({{0, 1}, {1, 16, burst_size}})
+    ->UseRealTime();
+
+// Receiver of the timers below, they are cancelled through the stop source
+struct stoppable_latch_receiver {
+	using receiver_concept = stdexec::receiver_t;
+
+	void set_value() noexcept { m_latch->count_down(); }
+
+	void set_stopped() noexcept { m_latch->count_down(); }
+
+	[[nodiscard]] auto get_env() const noexcept {
+		return stdexec::prop{stdexec::get_stop_token, m_stopSource->get_token()};
+	}
+
+	completion_latch*             m_latch;
+	stdexec::inplace_stop_source* m_stopSource;
+};
+
+// Timer of a QThreadScheduler, connected in place like operation
+struct timer_operation {
+	using sender_type = decltype(exec::schedule_after(
+	    std::declval<const QThreadScheduler&>(), std::chrono::milliseconds{}));
+
+	timer_operation(const QThreadScheduler& scheduler,
+	                std::chrono::milliseconds delay, completion_latch& latch,
+	                stdexec::inplace_stop_source& stopSource)
+	    : m_opState(stdexec::connect(
+	          exec::schedule_after(scheduler, delay),
+	          stoppable_latch_receiver{&latch, &stopSource})) {}
+
+	void start() noexcept { stdexec::start(m_opState); }
+
+	stdexec::connect_result_t<sender_type, stoppable_latch_receiver> m_opState;
+};
+
+// Timeout of the QThreadScheduler before the timer wheel: a QObject per timer,
+// moved to the thread of the scheduler, with a QBasicTimer and connections to
+// aboutToQuit and QThread::finished
+class qobject_timer : public QObject {
+public:
+	qobject_timer(QThread* thread, completion_latch& latch) : m_latch(&latch) {
+		moveToThread(thread);
+	}
+
+	void start(std::chrono::milliseconds delay) {
+		connect(qApp, &QCoreApplication::aboutToQuit, this,
+		        &qobject_timer::stop);
+		connect(thread(), &QThread::finished, this, &qobject_timer::stop);
+		m_timer.start(delay, this);
+	}
+
+	// Completes the timer unless it fired already, like its stop request
+	void stop() {
+		if (m_timer.isActive()) {
+			m_timer.stop();
+			m_latch->count_down();
+		}
+	}
+
+protected:
+	void timerEvent(QTimerEvent* /*event*/) override { stop(); }
+
+private:
+	QBasicTimer       m_timer;
+	completion_latch* m_latch;
+};
+
+// Delays of pending timers, ascending over an hour. Qt keeps its timers in a
+// sorted list, ascending delays are its best case with constant time inserts.
+auto pending_delay(std::size_t index, std::size_t count)
+    -> std::chrono::milliseconds {
+	return std::chrono::milliseconds{
+	    1'000 + static_cast<std::int64_t>(index * 3'600'000 / count)};
+}
+
+// Timers of a QThreadScheduler, they are cancelled and completed when the
+// object is destroyed
+class pending_scheduler_timers {
+public:
+	explicit pending_scheduler_timers(std::size_t count)
+	    : m_timers(std::make_unique<std::optional<timer_operation>[]>(count)),
+	      m_count(count), m_latch(count) {}
+
+	pending_scheduler_timers(const pending_scheduler_timers&) = delete;
+	pending_scheduler_timers(pending_scheduler_timers&&)      = delete;
+
+	~pending_scheduler_timers() {
+		m_stopSource.request_stop();
+		process_events_until([this]() { return m_latch.done(); });
+	}
+
+	void start() {
+		const QThreadScheduler scheduler(QThread::currentThread());
+		for (std::size_t i = 0; i < m_count; ++i) {
+			m_timers[i].emplace(scheduler, pending_delay(i, m_count), m_latch,
+			                    m_stopSource);
+			m_timers[i]->start();
+		}
+	}
+
+private:
+	std::unique_ptr<std::optional<timer_operation>[]> m_timers;
+	std::size_t                                       m_count;
+	completion_latch                                  m_latch;
+	stdexec::inplace_stop_source                      m_stopSource;
+};
+
+// The same with a QObject per timer
+class pending_qobject_timers {
+public:
+	explicit pending_qobject_timers(std::size_t count)
+	    : m_timers(std::make_unique<std::optional<qobject_timer>[]>(count)),
+	      m_count(count), m_latch(count) {}
+
+	pending_qobject_timers(const pending_qobject_timers&) = delete;
+	pending_qobject_timers(pending_qobject_timers&&)      = delete;
+
+	~pending_qobject_timers() {
+		for (std::size_t i = 0; i < m_count; ++i) {
+			if (m_timers[i].has_value()) {
+				m_timers[i]->stop();
+			}
+		}
+	}
+
+	void start() {
+		for (std::size_t i = 0; i < m_count; ++i) {
+			m_timers[i].emplace(QThread::currentThread(), m_latch);
+			m_timers[i]->start(pending_delay(i, m_count));
+		}
+	}
+
+private:
+	std::unique_ptr<std::optional<qobject_timer>[]> m_timers;
+	std::size_t                                     m_count;
+	completion_latch                                m_latch;
+};
+
+// Starts Arg pending timers, reports the time and the heap allocations and
+// bytes of a start per timer
+template <class Pending>
+void start_pending(benchmark::State& state, Pending& pending) {
+	const allocation_counter allocations;
+	const auto               startedAt = clock::now();
+	pending.start();
+	const auto count = static_cast<std::size_t>(state.range(0));
+	state.counters["start_ns_per_timer"] =
+	    std::chrono::duration<double, std::nano>(clock::now() - startedAt)
+	        .count() /
+	    static_cast<double>(count);
+	allocations.report(state, count, "timer");
+}
+
+// Arg timers started through exec::schedule_after, then the start and cancel
+// of one more timer while they are pending. Stop requests hop to the thread
+// of the timer wheel, so the cancel includes a trip through the event loop.
+void BM_QThreadScheduler_TimerStartCancel(benchmark::State& state) {
+	pending_scheduler_timers pending(static_cast<std::size_t>(state.range(0)));
+	start_pending(state, pending);
+
+	const QThreadScheduler scheduler(QThread::currentThread());
+
+	completion_latch                            latch;
+	std::optional<stdexec::inplace_stop_source> stopSource;
+	const allocation_counter                    allocations;
+	for (auto _ : state) {
+		latch.reset(1);
+		// A stop source can't be reset
+		stopSource.emplace();
+		timer_operation timer(scheduler, std::chrono::hours{1}, latch,
+		                      *stopSource);
+		timer.start();
+		stopSource->request_stop();
+		process_events_until([&]() { return latch.done(); });
+	}
+	state.SetItemsProcessed(state.iterations());
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_QThreadScheduler_TimerStartCancel)
+    ->ArgName("pending")
+    ->Arg(10'000)
+    ->Arg(100'000)
+    ->Arg(1'000'000);
+
+// Baseline of TimerStartCancel with a QObject per timer. Its stop request
+// called into the object directly when it was on the same thread.
+void BM_QObjectTimer_StartCancel(benchmark::State& state) {
+	pending_qobject_timers pending(static_cast<std::size_t>(state.range(0)));
+	start_pending(state, pending);
+
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(1);
+		qobject_timer timer(QThread::currentThread(), latch);
+		timer.start(std::chrono::hours{1});
+		QMetaObject::invokeMethod(&timer, [&timer]() { timer.stop(); });
+		process_events_until([&]() { return latch.done(); });
+	}
+	state.SetItemsProcessed(state.iterations());
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_QObjectTimer_StartCancel)
+    ->ArgName("pending")
+    ->Arg(10'000)
+    ->Arg(100'000)
+    ->Arg(1'000'000);
+
+struct wheel_timer : public detail::timer_node {
+	wheel_timer() noexcept : detail::timer_node(&wheel_timer::fire) {}
+
+	static void fire(detail::timer_node* /*node*/, bool /*stopped*/) noexcept {}
+};
+
+// Timers spread over 2^26 ticks, beyond the 2^24 ticks of the wheel levels
+auto pending_timers(detail::timer_wheel& wheel, std::size_t count)
+    -> std::unique_ptr<wheel_timer[]> {
+	auto            timers = std::make_unique<wheel_timer[]>(count);
+	std::mt19937_64 random(42);
+	std::uniform_int_distribution<std::uint64_t> expiry(
+	    1, std::uint64_t{1} << 26);
+	for (std::size_t i = 0; i < count; ++i) {
+		wheel.insert(&timers[i], expiry(random));
+	}
+	return timers;
+}
+
+// Insert and cancel of one timer while Arg timers are pending
+void BM_TimerWheel_InsertRemove(benchmark::State& state) {
+	detail::timer_wheel wheel;
+	const auto          timers =
+	    pending_timers(wheel, static_cast<std::size_t>(state.range(0)));
+	wheel_timer   timer;
+	std::uint64_t expiry = 0;
+	for (auto _ : state) {
+		expiry = expiry % (std::uint64_t{1} << 26) + 4099;
+		wheel.insert(&timer, expiry);
+		benchmark::DoNotOptimize(wheel.remove(&timer));
+	}
+	state.SetItemsProcessed(state.iterations());
+	wheel.cancel_all();
+}
+BENCHMARK(BM_TimerWheel_InsertRemove)
+    ->ArgName("pending")
+    ->Arg(10'000)
+    ->Arg(100'000)
+    ->Arg(1'000'000);
+
+// Expiry of Arg pending timers
+void BM_TimerWheel_Expire(benchmark::State& state) {
+	const auto count = static_cast<std::size_t>(state.range(0));
+	for (auto _ : state) {
+		state.PauseTiming();
+		detail::timer_wheel wheel;
+		const auto          timers = pending_timers(wheel, count);
+		state.ResumeTiming();
+		wheel.advance(std::uint64_t{1} << 26);
+	}
+	state.SetItemsProcessed(state.iterations() *
+	                        static_cast<std::int64_t>(count));
+}
+BENCHMARK(BM_TimerWheel_Expire)
+    ->ArgName("pending")
+    ->Arg(10'000)
+    ->Arg(100'000)
+    ->Arg(1'000'000)
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
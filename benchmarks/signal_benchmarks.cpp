@@ -0,0 +1,123 @@
+#include "benchmark_utils.hpp"
+
+#include <stdexecutils/qt/signal_sender.hpp>
+
+#include <QEventLoop>
+#include <QObject>
+#include <QString>
+
+#ifndef Q_MOC_RUN
+#include <exec/sequence/ignore_all_values.hpp>
+#include <exec/sequence/transform_each.hpp>
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+using namespace stdexecutils::qt;
+using namespace stdexecutils::qt::benchmarks;
+
+namespace {
+
+// objectNameChanged is only emitted when the name changes, the emitter
+// alternates between two shared names so emitting does not allocate
+class emitter {
+public:
+	void emit_signal() { m_object.setObjectName(m_names[++m_index % 2]); }
+
+	// Emits from the event loop of the thread
+	void post_emission() {
+		QMetaObject::invokeMethod(
+		    &m_object, [this]() { emit_signal(); }, Qt::QueuedConnection);
+	}
+
+	[[nodiscard]] auto object() noexcept -> QObject* { return &m_object; }
+
+private:
+	QObject                m_object;
+	std::array<QString, 2> m_names{QStringLiteral("a"), QStringLiteral("b")};
+	std::size_t            m_index{0};
+};
+
+// Waiting for an emission that happens right after the start, measures the
+// cost of connecting and disconnecting
+void BM_SignalSender_Await(benchmark::State& state) {
+	emitter                  source;
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(1);
+		operation op(signal_sender(source.object(), &QObject::objectNameChanged),
+		             latch);
+		op.start();
+		source.emit_signal();
+	}
+	state.SetItemsProcessed(state.iterations());
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_SignalSender_Await);
+
+// Waiting for an emission from the event loop
+void BM_SignalSender_AwaitPosted(benchmark::State& state) {
+	emitter                  source;
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(1);
+		operation op(signal_sender(source.object(), &QObject::objectNameChanged),
+		             latch);
+		op.start();
+		source.post_emission();
+		process_events_until([&]() { return latch.done(); });
+	}
+	state.SetItemsProcessed(state.iterations());
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_SignalSender_AwaitPosted);
+
+// The same wait with a nested QEventLoop and a context QObject per wait, the
+// usual way without senders
+void BM_SignalSender_EventLoopBaseline(benchmark::State& state) {
+	emitter                  source;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		QEventLoop loop;
+		QObject    context;
+		QObject::connect(source.object(), &QObject::objectNameChanged, &context,
+		                 [&loop]() { loop.quit(); });
+		source.post_emission();
+		loop.exec();
+	}
+	state.SetItemsProcessed(state.iterations());
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_SignalSender_EventLoopBaseline);
+
+// Emissions delivered by one subscribed signal_sequence
+void BM_SignalSequence_Emissions(benchmark::State& state) {
+	auto                     source = std::make_unique<emitter>();
+	std::size_t              items  = 0;
+	completion_latch         latch;
+	const allocation_counter allocations;
+	{
+		operation op(exec::ignore_all_values(exec::transform_each(
+		                 signal_sequence(source->object(),
+		                                 &QObject::objectNameChanged),
+		                 stdexec::then([&items](const QString&) { ++items; }))),
+		             latch);
+		op.start();
+		for (auto _ : state) {
+			source->emit_signal();
+		}
+		// The sequence ends with its object
+		source.reset();
+		latch.wait();
+	}
+	state.SetItemsProcessed(static_cast<std::int64_t>(items));
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_SignalSequence_Emissions);
+
+} // namespace
@@ -0,0 +1,181 @@
+#include "benchmark_utils.hpp"
+
+#include <stdexecutils/qt/qthreadpool_scheduler.hpp>
+
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace stdexecutils::qt;
+using namespace stdexecutils::qt::benchmarks;
+
+namespace {
+
+constexpr std::size_t burst_size = 10'000;
+
+// Pool thread counts from 1 to the number of cores
+void thread_counts(benchmark::internal::Benchmark* benchmark) {
+	const auto cores = std::max(QThread::idealThreadCount(), 1);
+	for (int threads = 1; threads < cores; threads *= 2) {
+		benchmark->Arg(threads);
+	}
+	benchmark->Arg(cores);
+}
+
+// Round trip of one schedule() onto an idle pool
+void BM_ThreadpoolScheduler_ScheduleLatency(benchmark::State& state) {
+	QThreadPool              pool;
+	auto                     scheduler = qthread_scheduler(&pool);
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(1);
+		operation op(stdexec::schedule(scheduler), latch);
+		op.start();
+		latch.wait();
+	}
+	state.SetItemsProcessed(state.iterations());
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_ThreadpoolScheduler_ScheduleLatency)->UseRealTime();
+
+// Baseline of ScheduleLatency: QThreadPool::start with a functor, which wraps
+// it in a heap allocated QRunnable
+void BM_QThreadPool_StartFunctorLatency(benchmark::State& state) {
+	QThreadPool              pool;
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(1);
+		pool.start([&latch]() { latch.count_down(); });
+		latch.wait();
+	}
+	state.SetItemsProcessed(state.iterations());
+	allocations.report(state, state.iterations());
+}
+BENCHMARK(BM_QThreadPool_StartFunctorLatency)->UseRealTime();
+
+// Bursts of schedule() onto a pool with Arg threads
+void BM_ThreadpoolScheduler_Throughput(benchmark::State& state) {
+	QThreadPool pool;
+	pool.setMaxThreadCount(static_cast<int>(state.range(0)));
+	auto            scheduler = qthread_scheduler(&pool);
+	operation_batch batch(burst_size,
+	                      [&]() { return stdexec::schedule(scheduler); });
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(batch.size());
+		batch.start(latch);
+		latch.wait();
+	}
+	const auto operations = state.iterations() * batch.size();
+	state.SetItemsProcessed(static_cast<std::int64_t>(operations));
+	allocations.report(state, operations);
+}
+BENCHMARK(BM_ThreadpoolScheduler_Throughput)
+    ->ArgName("threads")
+    ->Apply(thread_counts)
+    ->UseRealTime();
+
+// Baseline of Throughput: bursts of QThreadPool::start with a functor
+void BM_QThreadPool_StartFunctorThroughput(benchmark::State& state) {
+	QThreadPool pool;
+	pool.setMaxThreadCount(static_cast<int>(state.range(0)));
+	completion_latch         latch;
+	const allocation_counter allocations;
+	for (auto _ : state) {
+		latch.reset(burst_size);
+		for (std::size_t i = 0; i < burst_size; ++i) {
+			pool.start([&latch]() { latch.count_down(); });
+		}
+		latch.wait();
+	}
+	const auto operations = state.iterations() * burst_size;
+	state.SetItemsProcessed(static_cast<std::int64_t>(operations));
+	allocations.report(state, operations);
+}
+BENCHMARK(BM_QThreadPool_StartFunctorThroughput)
+    ->ArgName("threads")
+    ->Apply(thread_counts)
+    ->UseRealTime();
+
+// Parallel bulk over 4M elements on a pool with Arg threads
+void BM_ThreadpoolScheduler_Bulk(benchmark::State& state) {
+	QThreadPool pool;
+	pool.setMaxThreadCount(static_cast<int>(state.range(0)));
+	auto               scheduler = qthread_scheduler(&pool);
+	std::vector<float> values(std::size_t{1} << 22);
+	for (auto _ : state) {
+		stdexec::sync_wait(stdexec::schedule(scheduler) |
+		                   stdexec::bulk(values.size(), [&](std::size_t index) {
+			                   values[index] = std::sqrt(static_cast<float>(index));
+		                   }));
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() *
+	                        static_cast<std::int64_t>(values.size()));
+}
+BENCHMARK(BM_ThreadpoolScheduler_Bulk)
+    ->ArgName("threads")
+    ->Apply(thread_counts)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Latency of one schedule() with the priority Arg on a single thread pool
+// that is saturated with 1000 tasks of priority 0
+void BM_ThreadpoolScheduler_PriorityLatency(benchmark::State& state) {
+	QThreadPool pool;
+	pool.setMaxThreadCount(1);
+	auto background = qthread_scheduler(&pool);
+	auto scheduler =
+	    qthread_scheduler(&pool, static_cast<int>(state.range(0)));
+	operation_batch load(1000, [&]() {
+		return stdexec::schedule(background) | stdexec::then(busy_work{});
+	});
+	completion_latch latch;
+	completion_latch loadLatch;
+	latency_recorder latencies(1 << 16);
+	for (auto _ : state) {
+		loadLatch.reset(load.size());
+		load.start(loadLatch);
+		latch.reset(1);
+		operation  op(stdexec::schedule(scheduler), latch);
+		const auto started = clock::now();
+		op.start();
+		latch.wait();
+		latencies.add(latch.completed_at() - started);
+		loadLatch.wait();
+	}
+	latencies.report(state);
+}
+BENCHMARK(BM_ThreadpoolScheduler_PriorityLatency)
+    ->ArgName("priority")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime();
+
+// Lateness of schedule_after with a 1 ms delay
+void BM_ThreadpoolScheduler_ScheduleAfterJitter(benchmark::State& state) {
+	QThreadPool      pool;
+	auto             scheduler = qthread_scheduler(&pool);
+	completion_latch latch;
+	latency_recorder lateness(1000);
+	for (auto _ : state) {
+		latch.reset(1);
+		const auto deadline = scheduler.now() + std::chrono::milliseconds{1};
+		operation  op(scheduler.schedule_at(deadline), latch);
+		op.start();
+		latch.wait();
+		lateness.add(latch.completed_at() - deadline);
+	}
+	lateness.report(state);
+}
+BENCHMARK(BM_ThreadpoolScheduler_ScheduleAfterJitter)
+    ->Iterations(1000)
+    ->UseRealTime();
+
+} // namespace
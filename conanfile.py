@@ -17,8 +17,8 @@ class StdexecutilsConan(ConanFile):
 
     # Binary configuration
     settings = "os", "compiler", "build_type", "arch"
-    options = {"qml": [True, False], "shared": [True, False]}
-    default_options = {"qml": False, "shared": False}
+    options = {"qml": [True, False], "shared": [True, False], "benchmarks": [True, False], "tracing": [True, False]}
+    default_options = {"qml": False, "shared": False, "benchmarks": False, "tracing": False}
 
     # generators
     generators = ["CMakeDeps"]
@@ -38,6 +38,8 @@ class StdexecutilsConan(ConanFile):
     # Add dependencies for building the package here
     def build_requirements(self):
         self.test_requires("gtest/[>=1.15 <2]")
+        if self.options.benchmarks:
+            self.test_requires("benchmark/[>=1.8 <2]")
         self.tool_requires("ninja/[>=1.13 <2]")
 
     def layout(self):
@@ -71,6 +73,8 @@ class StdexecutilsConan(ConanFile):
         tc.cache_variables["CONAN_PACKAGE_DESCRIPTION"] = self.description
         tc.cache_variables["CONAN_PACKAGE_URL"] = self.url
         tc.cache_variables["BUILD_QML"] = self.options.qml
+        tc.cache_variables["BUILD_BENCHMARKS"] = self.options.benchmarks
+        tc.cache_variables["ENABLE_TRACING"] = self.options.tracing
         tc.generate()
 
     def build(self):
@@ -0,0 +1,397 @@
+#ifndef STDEXEC_UTILS_BOUNDED_SCHEDULER_HPP
+#define STDEXEC_UTILS_BOUNDED_SCHEDULER_HPP
+
+#ifndef Q_MOC_RUN
+#include <stdexec/execution.hpp>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace stdexecutils::qt {
+namespace detail {
+
+// Intrusive node of the FIFO of parked operations. Operation states derive
+// from it so parking them does not allocate.
+struct bounded_waiter {
+	using resume_fn = void (*)(bounded_waiter*) noexcept;
+
+	explicit bounded_waiter(resume_fn resume) noexcept : m_resume(resume) {}
+
+	bounded_waiter* m_next{nullptr};
+	bounded_waiter* m_prev{nullptr};
+	resume_fn       m_resume;
+};
+
+// Slots of a bounded scheduler, shared by its copies. Operations that find no
+// free slot are parked in FIFO order, a released slot is handed over to the
+// oldest of them.
+class bounded_limiter {
+public:
+	explicit bounded_limiter(std::size_t maxInFlight) noexcept
+	    : m_maxInFlight(std::max(maxInFlight, std::size_t{1})) {}
+
+	bounded_limiter(const bounded_limiter&) = delete;
+	bounded_limiter(bounded_limiter&&)      = delete;
+
+	[[nodiscard]] auto try_acquire() noexcept -> bool {
+		const std::lock_guard lock(m_mutex);
+		if (m_inFlight == m_maxInFlight) {
+			return false;
+		}
+		++m_inFlight;
+		return true;
+	}
+
+	enum class admission { acquired, parked, stopped };
+
+	// Takes a slot, or parks the waiter until one is handed over. Checking for
+	// a stop request under the lock leaves no gap between the check and
+	// parking, a later request finds the waiter parked.
+	template <class Stopped>
+	[[nodiscard]] auto acquire_or_park(bounded_waiter* waiter,
+	                                   Stopped&&       stopped) noexcept
+	    -> admission {
+		const std::lock_guard lock(m_mutex);
+		if (m_inFlight < m_maxInFlight) {
+			++m_inFlight;
+			return admission::acquired;
+		}
+		if (stopped()) {
+			return admission::stopped;
+		}
+		waiter->m_next = nullptr;
+		waiter->m_prev = m_tail;
+		if (m_tail != nullptr) {
+			m_tail->m_next = waiter;
+		} else {
+			m_head = waiter;
+		}
+		m_tail = waiter;
+		++m_parked;
+		return admission::parked;
+	}
+
+	// Unparks a waiter that got stopped, fails if it was resumed already
+	[[nodiscard]] auto remove(bounded_waiter* waiter) noexcept -> bool {
+		const std::lock_guard lock(m_mutex);
+		if (waiter->m_prev == nullptr && m_head != waiter) {
+			return false;
+		}
+		unlink(waiter);
+		return true;
+	}
+
+	// Hands the slot over to the oldest parked waiter, which resumes on the
+	// calling thread
+	void release() noexcept {
+		bounded_waiter* waiter = nullptr;
+		{
+			const std::lock_guard lock(m_mutex);
+			waiter = m_head;
+			if (waiter == nullptr) {
+				--m_inFlight;
+				return;
+			}
+			unlink(waiter);
+		}
+		waiter->m_resume(waiter);
+	}
+
+	[[nodiscard]] auto in_flight() const noexcept -> std::size_t {
+		const std::lock_guard lock(m_mutex);
+		return m_inFlight;
+	}
+
+	[[nodiscard]] auto parked() const noexcept -> std::size_t {
+		const std::lock_guard lock(m_mutex);
+		return m_parked;
+	}
+
+	[[nodiscard]] auto max_in_flight() const noexcept -> std::size_t {
+		return m_maxInFlight;
+	}
+
+private:
+	void unlink(bounded_waiter* waiter) noexcept {
+		if (waiter->m_prev != nullptr) {
+			waiter->m_prev->m_next = waiter->m_next;
+		} else {
+			m_head = waiter->m_next;
+		}
+		if (waiter->m_next != nullptr) {
+			waiter->m_next->m_prev = waiter->m_prev;
+		} else {
+			m_tail = waiter->m_prev;
+		}
+		waiter->m_next = nullptr;
+		waiter->m_prev = nullptr;
+		--m_parked;
+	}
+
+	mutable std::mutex m_mutex;
+	const std::size_t  m_maxInFlight;
+	std::size_t        m_inFlight{0};
+	std::size_t        m_parked{0};
+	bounded_waiter*    m_head{nullptr};
+	bounded_waiter*    m_tail{nullptr};
+};
+
+template <class Scheduler>
+class bounded_scheduler;
+
+template <class Scheduler>
+using bounded_inner_sender =
+    stdexec::schedule_result_t<std::add_lvalue_reference_t<Scheduler>>;
+
+// Operation state of a bounded schedule(). It takes a slot before it starts
+// the schedule() of the wrapped scheduler, or waits parked for one. The slot
+// is held until the completion of the receiver returns, so the continuation
+// that runs inline counts as in flight.
+template <class Scheduler, class Recv>
+class bounded_op_state : private bounded_waiter {
+public:
+	bounded_op_state(Recv&& receiver, Scheduler scheduler,
+	                 std::shared_ptr<bounded_limiter> limiter)
+	    : bounded_waiter(&bounded_op_state::resume),
+	      m_receiver(std::move(receiver)), m_limiter(std::move(limiter)),
+	      m_inner(stdexec::connect(stdexec::schedule(scheduler),
+	                               inner_receiver{this})) {}
+
+	bounded_op_state(const bounded_op_state&) = delete;
+	bounded_op_state(bounded_op_state&&)      = delete;
+
+	void start() noexcept {
+		stdexec::stoppable_token auto stop_token =
+		    stdexec::get_stop_token(stdexec::get_env(m_receiver));
+		if (stop_token.stop_requested()) {
+			stdexec::set_stopped(std::move(m_receiver));
+			return;
+		}
+		if (m_limiter->try_acquire()) {
+			stdexec::start(m_inner);
+			return;
+		}
+		if (stop_token.stop_possible()) {
+			// Registered before parking, the waiter may be resumed right away
+			m_stoppedCallback.emplace(std::move(stop_token),
+			                          stop_callback_fun{*this});
+		}
+		const auto admission = m_limiter->acquire_or_park(this, [this]() {
+			return stdexec::get_stop_token(stdexec::get_env(m_receiver))
+			    .stop_requested();
+		});
+		switch (admission) {
+		case bounded_limiter::admission::acquired:
+			m_stoppedCallback.reset();
+			stdexec::start(m_inner);
+			break;
+		case bounded_limiter::admission::stopped:
+			m_stoppedCallback.reset();
+			stdexec::set_stopped(std::move(m_receiver));
+			break;
+		case bounded_limiter::admission::parked:
+			// The operation state may already be resumed on another thread
+			break;
+		}
+	}
+
+private:
+	struct stop_callback_fun {
+		bounded_op_state& op_state;
+
+		void operator()() noexcept {
+			// Fails if the waiter already got a slot, it then observes the stop
+			// request itself
+			if (op_state.m_limiter->remove(&op_state)) {
+				// The reset destroys this functor, its members are gone afterwards
+				auto& self = op_state;
+				self.m_stoppedCallback.reset();
+				stdexec::set_stopped(std::move(self.m_receiver));
+			}
+		}
+	};
+
+	struct inner_receiver {
+		using __id = inner_receiver;
+		using __t  = inner_receiver;
+
+		using receiver_concept = stdexec::receiver_t;
+
+		void set_value() noexcept {
+			m_opState->complete([](Recv&& receiver) noexcept {
+				stdexec::set_value(std::move(receiver));
+			});
+		}
+
+		template <class Error>
+		void set_error(Error&& error) noexcept {
+			m_opState->complete([&error](Recv&& receiver) noexcept {
+				stdexec::set_error(std::move(receiver), std::forward<Error>(error));
+			});
+		}
+
+		void set_stopped() noexcept {
+			m_opState->complete([](Recv&& receiver) noexcept {
+				stdexec::set_stopped(std::move(receiver));
+			});
+		}
+
+		[[nodiscard]] auto get_env() const noexcept -> stdexec::env_of_t<Recv> {
+			return stdexec::get_env(m_opState->m_receiver);
+		}
+
+		bounded_op_state* m_opState;
+	};
+
+	// Called by release() with the slot handed over
+	static void resume(bounded_waiter* waiter) noexcept {
+		auto& self = *static_cast<bounded_op_state*>(waiter);
+		// Waits for a concurrently running stop callback
+		self.m_stoppedCallback.reset();
+		if (stdexec::get_stop_token(stdexec::get_env(self.m_receiver))
+		        .stop_requested()) {
+			self.complete([](Recv&& receiver) noexcept {
+				stdexec::set_stopped(std::move(receiver));
+			});
+			return;
+		}
+		stdexec::start(self.m_inner);
+	}
+
+	// The completion may destroy the operation state, the slot is released
+	// through a local reference
+	template <class Completion>
+	void complete(Completion completion) noexcept {
+		const auto limiter = std::move(m_limiter);
+		completion(std::move(m_receiver));
+		limiter->release();
+	}
+
+	using stop_callback = stdexec::stop_callback_for_t<
+	    stdexec::stop_token_of_t<stdexec::env_of_t<Recv>>, stop_callback_fun>;
+	using inner_op_state =
+	    stdexec::connect_result_t<bounded_inner_sender<Scheduler>,
+	                              inner_receiver>;
+
+	Recv                             m_receiver;
+	std::shared_ptr<bounded_limiter> m_limiter;
+	std::optional<stop_callback>     m_stoppedCallback;
+	inner_op_state                   m_inner;
+};
+
+template <class Scheduler>
+struct bounded_env {
+	template <stdexec::__completion_tag Tag>
+	auto query(stdexec::get_completion_scheduler_t<Tag>) const noexcept
+	    -> bounded_scheduler<Scheduler> {
+		return m_scheduler;
+	}
+
+	bounded_scheduler<Scheduler> m_scheduler;
+};
+
+template <class Scheduler>
+struct bounded_sender {
+	using __id = bounded_sender;
+	using __t  = bounded_sender;
+
+	using sender_concept = stdexec::sender_t;
+
+	template <class Env>
+	using completion_signatures_t = stdexec::transform_completion_signatures_of<
+	    bounded_inner_sender<Scheduler>, Env,
+	    stdexec::completion_signatures<stdexec::set_stopped_t()>>;
+
+	explicit bounded_sender(bounded_scheduler<Scheduler> scheduler) noexcept
+	    : m_scheduler(std::move(scheduler)) {}
+
+	template <class Env>
+	auto get_completion_signatures(Env&& /*env*/) const
+	    -> completion_signatures_t<std::decay_t<Env>> {
+		return {};
+	}
+
+	auto get_env() const noexcept -> bounded_env<Scheduler> {
+		return {m_scheduler};
+	}
+
+	template <stdexec::receiver Recv>
+	auto connect(Recv recv) const -> bounded_op_state<Scheduler, Recv> {
+		return {std::move(recv), m_scheduler.m_scheduler, m_scheduler.m_limiter};
+	}
+
+private:
+	bounded_scheduler<Scheduler> m_scheduler;
+};
+
+// Scheduler that admits at most max_in_flight operations to the wrapped
+// scheduler at a time, see bounded()
+template <class Scheduler>
+class bounded_scheduler {
+public:
+	using __id = bounded_scheduler;
+	using __t  = bounded_scheduler;
+
+	bounded_scheduler(Scheduler scheduler, std::size_t maxInFlight)
+	    : m_scheduler(std::move(scheduler)),
+	      m_limiter(std::make_shared<bounded_limiter>(maxInFlight)) {}
+
+	auto schedule() const noexcept -> bounded_sender<Scheduler> {
+		return bounded_sender<Scheduler>(*this);
+	}
+
+	// Operations that hold a slot
+	[[nodiscard]] auto in_flight() const noexcept -> std::size_t {
+		return m_limiter->in_flight();
+	}
+
+	// Operations that wait for a slot
+	[[nodiscard]] auto parked() const noexcept -> std::size_t {
+		return m_limiter->parked();
+	}
+
+	[[nodiscard]] auto max_in_flight() const noexcept -> std::size_t {
+		return m_limiter->max_in_flight();
+	}
+
+	[[nodiscard]] auto base() const noexcept -> const Scheduler& {
+		return m_scheduler;
+	}
+
+	// Copies share their slots
+	auto operator==(const bounded_scheduler& other) const noexcept -> bool {
+		return m_limiter == other.m_limiter;
+	}
+
+private:
+	friend struct bounded_sender<Scheduler>;
+
+	Scheduler                        m_scheduler;
+	std::shared_ptr<bounded_limiter> m_limiter;
+};
+} // namespace detail
+
+// Wraps a scheduler so that at most maxInFlight of the operations scheduled
+// through it, and of all its copies, are queued on or running in the wrapped
+// scheduler. The others are parked in FIFO order, without allocating, until
+// an earlier one completes. A stop request takes a parked operation out of
+// the queue and completes it with set_stopped right away.
+//
+// An operation holds its slot until the continuation that runs inline on its
+// completion returns. Work that blocks in there on other work of the same
+// bounded scheduler can deadlock.
+template <stdexec::scheduler Scheduler>
+auto bounded(Scheduler scheduler, std::size_t maxInFlight)
+    -> detail::bounded_scheduler<Scheduler> {
+	return {std::move(scheduler), maxInFlight};
+}
+
+} // namespace stdexecutils::qt
+
+#endif // STDEXEC_UTILS_BOUNDED_SCHEDULER_HPP
@@ -0,0 +1,142 @@
+#ifndef STDEXEC_UTILS_DETAIL_METRICS_RECORDER_HPP
+#define STDEXEC_UTILS_DETAIL_METRICS_RECORDER_HPP
+
+#include <stdexecutils/qt/metrics.hpp>
+
+#include <QObject>
+#include <QThreadPool>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace stdexecutils::qt::detail {
+
+// duration_histogram that is recorded into from any thread
+class histogram_recorder {
+public:
+	void record(std::chrono::nanoseconds duration) noexcept {
+		const auto value = static_cast<std::uint64_t>(
+		    std::max(duration.count(), std::chrono::nanoseconds::rep{0}));
+		m_buckets[duration_histogram::bucket_index(value)].fetch_add(
+		    1, std::memory_order_relaxed);
+		m_sum.fetch_add(value, std::memory_order_relaxed);
+		auto max = m_max.load(std::memory_order_relaxed);
+		while (value > max && !m_max.compare_exchange_weak(
+		                          max, value, std::memory_order_relaxed)) {
+		}
+	}
+
+	// The buckets are read one by one, values recorded meanwhile may be partly
+	// included
+	[[nodiscard]] auto snapshot() const noexcept -> duration_histogram {
+		duration_histogram histogram;
+		for (std::size_t index = 0; index < duration_histogram::bucket_count;
+		     ++index) {
+			histogram.m_buckets[index] =
+			    m_buckets[index].load(std::memory_order_relaxed);
+			histogram.m_count += histogram.m_buckets[index];
+		}
+		histogram.m_sum = m_sum.load(std::memory_order_relaxed);
+		histogram.m_max = m_max.load(std::memory_order_relaxed);
+		return histogram;
+	}
+
+private:
+	std::array<std::atomic<std::uint64_t>, duration_histogram::bucket_count>
+	                           m_buckets{};
+	std::atomic<std::uint64_t> m_sum{0};
+	std::atomic<std::uint64_t> m_max{0};
+};
+
+// Metrics of the work queued to a QThread or QThreadPool. Recording is off
+// until enable() is called, then it costs a clock read and a few relaxed
+// atomic operations per operation. snapshot() can be called from any thread.
+class metrics_recorder {
+public:
+	using clock = std::chrono::steady_clock;
+
+	void enable() noexcept { m_enabled.store(true, std::memory_order_relaxed); }
+
+	[[nodiscard]] auto enabled() const noexcept -> bool {
+		return m_enabled.load(std::memory_order_relaxed);
+	}
+
+	// Returns the time stamp to pass to started() or dequeued(), a default
+	// constructed one while recording is off
+	[[nodiscard]] auto enqueued() noexcept -> clock::time_point {
+		if (!enabled()) {
+			return {};
+		}
+		const auto pending = m_pending.fetch_add(1, std::memory_order_relaxed) + 1;
+		auto       peak    = m_peakPending.load(std::memory_order_relaxed);
+		while (pending > peak && !m_peakPending.compare_exchange_weak(
+		                             peak, pending, std::memory_order_relaxed)) {
+		}
+		return clock::now();
+	}
+
+	// Work that is dequeued without running, like cancelled work. Work that
+	// was queued while recording was off is not counted.
+	void dequeued(clock::time_point enqueuedAt) noexcept {
+		if (enqueuedAt != clock::time_point{}) {
+			m_pending.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	void started(clock::time_point enqueuedAt) noexcept {
+		if (enqueuedAt != clock::time_point{}) {
+			m_pending.fetch_sub(1, std::memory_order_relaxed);
+			m_delay.record(clock::now() - enqueuedAt);
+		}
+	}
+
+	void timer_started(clock::time_point deadline) noexcept {
+		if (enabled()) {
+			m_timerLateness.record(clock::now() - deadline);
+		}
+	}
+
+	[[nodiscard]] auto snapshot() const noexcept -> scheduler_metrics {
+		return {m_pending.load(std::memory_order_relaxed),
+		        m_peakPending.load(std::memory_order_relaxed), m_delay.snapshot(),
+		        m_timerLateness.snapshot()};
+	}
+
+	// Recorder of a pool, it is created on first use and lives as long as the
+	// QThreadPool object
+	static auto for_pool(QThreadPool* pool) -> metrics_recorder* {
+		static std::mutex                                       mutex;
+		static std::unordered_map<QThreadPool*, metrics_recorder*> recorders;
+
+		const std::lock_guard lock(mutex);
+		if (const auto it = recorders.find(pool); it != recorders.end()) {
+			return it->second;
+		}
+		auto* const recorder = new metrics_recorder();
+		recorders.emplace(pool, recorder);
+		QObject::connect(pool, &QObject::destroyed, [pool]() {
+			const std::lock_guard lock(mutex);
+			if (const auto it = recorders.find(pool); it != recorders.end()) {
+				delete it->second;
+				recorders.erase(it);
+			}
+		});
+		return recorder;
+	}
+
+private:
+	std::atomic<bool>         m_enabled{false};
+	std::atomic<std::int64_t> m_pending{0};
+	std::atomic<std::int64_t> m_peakPending{0};
+	histogram_recorder        m_delay;
+	histogram_recorder        m_timerLateness;
+};
+
+} // namespace stdexecutils::qt::detail
+
+#endif // STDEXEC_UTILS_DETAIL_METRICS_RECORDER_HPP
@@ -0,0 +1,169 @@
+#ifndef STDEXEC_UTILS_DETAIL_OBJECT_OPERATION_HPP
+#define STDEXEC_UTILS_DETAIL_OBJECT_OPERATION_HPP
+
+#include <stdexecutils/qt/detail/qthread_context.hpp>
+
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+
+#ifndef Q_MOC_RUN
+#include <stdexec/execution.hpp>
+#endif
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace stdexecutils::qt::detail {
+
+// Operation state that waits for signals of a QObject, with up to Connections
+// connections besides the one to its destroyed signal. All of its state lives
+// in the operation state, no QObject is created per operation.
+//
+// The connections are direct, so the signals must be emitted on the thread of
+// the object, as usual for QObjects. They are made and released on that
+// thread as well: operations started elsewhere and stop requests hop over
+// with a task, like the timers of QThreadScheduler.
+//
+// Derived makes its connections in on_connect(), which returns false if it
+// completed right away instead. If a connection fails, e.g. out of memory,
+// the operation completes with set_error(std::exception_ptr). Derived handles
+// the destruction of the object in on_destroyed() and stop requests in
+// on_cancel(), after the connections are released.
+template <class Derived, class Recv, class Object, std::size_t Connections>
+class object_operation {
+public:
+	object_operation(Recv&& receiver, Object* object)
+	    : m_receiver(std::move(receiver)), m_object(object),
+	      m_context(qthread_context::for_thread(object->thread())) {}
+
+	object_operation(const object_operation&) = delete;
+	object_operation(object_operation&&)      = delete;
+
+	void start() noexcept {
+		if (stdexec::get_stop_token(stdexec::get_env(m_receiver))
+		        .stop_requested()) {
+			stdexec::set_stopped(std::move(m_receiver));
+			return;
+		}
+		if (QThread::currentThread() == m_context->thread()) {
+			connect_object();
+		} else {
+			// The object may be destroyed before the task runs
+			m_guard = m_object;
+			m_context->push(&m_connectTask);
+		}
+	}
+
+protected:
+	struct task : public run_queue_task {
+		task(object_operation& opState, execute_fn execute) noexcept
+		    : run_queue_task(execute), op_state(opState) {}
+
+		object_operation& op_state;
+	};
+
+	// Connects the signal of the object to the slot, on its thread
+	template <class Signal, class Slot>
+	void connect_signal(Signal signal, Slot slot) {
+		m_connections[m_connectionCount++] =
+		    QObject::connect(m_object, signal, std::move(slot));
+	}
+
+	// Releases the connections. Returns false if a stop request queued a task
+	// that still references the operation state, it completes it instead.
+	auto disconnect() noexcept -> bool {
+		for (std::size_t index = 0; index < m_connectionCount; ++index) {
+			QObject::disconnect(m_connections[index]);
+		}
+		QObject::disconnect(m_destroyedConnection);
+		// Waits for a concurrently running stop callback
+		m_stoppedCallback.reset();
+		return !m_cancelQueued.load(std::memory_order_acquire);
+	}
+
+	[[nodiscard]] auto object() const noexcept -> Object& { return *m_object; }
+
+	[[nodiscard]] auto context() const noexcept -> qthread_context* {
+		return m_context;
+	}
+
+	Recv m_receiver;
+
+private:
+	struct stop_callback_fun {
+		object_operation& op_state;
+
+		void operator()() noexcept {
+			// Only the thread of the object may release the connections
+			if (!op_state.m_cancelQueued.exchange(true,
+			                                      std::memory_order_acq_rel)) {
+				op_state.m_context->push(&op_state.m_cancelTask);
+			}
+		}
+	};
+
+	void connect_object() noexcept {
+		auto& self = static_cast<Derived&>(*this);
+		try {
+			if (!self.on_connect()) {
+				return;
+			}
+			m_destroyedConnection = QObject::connect(
+			    m_object, &QObject::destroyed, [&self]() { self.on_destroyed(); });
+		} catch (...) {
+			// Qt allocates the connections, the ones made so far are released
+			disconnect();
+			stdexec::set_error(std::move(m_receiver), std::current_exception());
+			return;
+		}
+		stdexec::stoppable_token auto stop_token =
+		    stdexec::get_stop_token(stdexec::get_env(m_receiver));
+		if (stop_token.stop_possible()) {
+			m_stoppedCallback.emplace(std::move(stop_token),
+			                          stop_callback_fun{*this});
+		}
+	}
+
+	static void on_connect_task(run_queue_task* connectTask,
+	                            bool            stopped) noexcept {
+		auto& self = static_cast<task*>(connectTask)->op_state;
+		if (stopped || self.m_guard.isNull() ||
+		    stdexec::get_stop_token(stdexec::get_env(self.m_receiver))
+		        .stop_requested()) {
+			stdexec::set_stopped(std::move(self.m_receiver));
+			return;
+		}
+		self.connect_object();
+	}
+
+	static void on_cancel_task(run_queue_task* cancelTask,
+	                           bool /*stopped*/) noexcept {
+		auto& self = static_cast<task*>(cancelTask)->op_state;
+		self.disconnect();
+		static_cast<Derived&>(self).on_cancel();
+	}
+
+	using stop_callback = stdexec::stop_callback_for_t<
+	    stdexec::stop_token_of_t<stdexec::env_of_t<Recv>>, stop_callback_fun>;
+
+	Object* const                                    m_object;
+	QPointer<QObject>                                m_guard;
+	qthread_context* const                           m_context;
+	std::array<QMetaObject::Connection, Connections> m_connections;
+	std::size_t                                      m_connectionCount{0};
+	QMetaObject::Connection                          m_destroyedConnection;
+
+	task                         m_connectTask{*this, &on_connect_task};
+	task                         m_cancelTask{*this, &on_cancel_task};
+	std::atomic<bool>            m_cancelQueued{false};
+	std::optional<stop_callback> m_stoppedCallback;
+};
+
+} // namespace stdexecutils::qt::detail
+
+#endif // STDEXEC_UTILS_DETAIL_OBJECT_OPERATION_HPP
@@ -0,0 +1,442 @@
+#ifndef STDEXEC_UTILS_DETAIL_QTHREAD_CONTEXT_HPP
+#define STDEXEC_UTILS_DETAIL_QTHREAD_CONTEXT_HPP
+
+#include <stdexecutils/qt/detail/metrics_recorder.hpp>
+#include <stdexecutils/qt/detail/timer_wheel.hpp>
+
+#include <QBasicTimer>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QThread>
+#include <QTimerEvent>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef Q_OS_LINUX
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace stdexecutils::qt::detail {
+
+// Intrusive node of the per-thread run queue. Operation states derive from it
+// so enqueueing them does not allocate.
+struct run_queue_task {
+	using execute_fn = void (*)(run_queue_task*, bool stopped) noexcept;
+
+	explicit run_queue_task(execute_fn execute) noexcept : m_execute(execute) {}
+
+	run_queue_task*                       m_next{nullptr};
+	execute_fn                            m_execute;
+	std::chrono::steady_clock::time_point m_enqueuedAt;
+};
+
+// Per-QThread state shared by all schedulers of that thread.
+//
+// Tasks are pushed into multi-producer single-consumer queues from any
+// thread, one queue per Qt::EventPriority. Only the first push after a drain
+// posts an event with the priority of the queue, a whole burst of tasks is
+// then executed by a single event-loop callback.
+//
+// On Linux the wakeup can be switched to an eventfd that is watched by a
+// QSocketNotifier, see enable_eventfd_wakeup(). The first push after a drain
+// then writes the eventfd instead of allocating and posting an event.
+//
+// Timers are kept in timer wheels, one per Qt::TimerType, each driven by a
+// single Qt timer of that type. The wheels must only be accessed from the
+// thread of the context, operation states started elsewhere hop over with a
+// task first.
+class qthread_context : public QObject {
+public:
+	using clock = std::chrono::steady_clock;
+
+	qthread_context(const qthread_context&) = delete;
+	qthread_context(qthread_context&&)      = delete;
+
+	~qthread_context() override {
+		// Pending drain events reference this context, remove them while it is
+		// still fully constructed
+		QCoreApplication::removePostedEvents(this, drain_event::event_type());
+		// Tasks woken through the eventfd have no event that completes them
+		for (const auto priority : {Qt::HighEventPriority, Qt::NormalEventPriority,
+		                            Qt::LowEventPriority}) {
+			drain(priority, true);
+		}
+		cancel_timers();
+#ifdef Q_OS_LINUX
+		if (m_eventfd >= 0) {
+			::close(m_eventfd);
+		}
+#endif
+	}
+
+	// Returns the context of the given thread, it is created on first use and
+	// lives as long as the QThread object
+	static auto for_thread(QThread* thread) -> qthread_context* {
+		static std::mutex                                    mutex;
+		static std::unordered_map<QThread*, qthread_context*> contexts;
+
+		const std::lock_guard lock(mutex);
+		if (const auto it = contexts.find(thread); it != contexts.end()) {
+			return it->second;
+		}
+		auto* const context = new qthread_context(thread);
+		contexts.emplace(thread, context);
+		QObject::connect(thread, &QObject::destroyed, [thread]() {
+			const std::lock_guard lock(mutex);
+			if (const auto it = contexts.find(thread); it != contexts.end()) {
+				delete it->second;
+				contexts.erase(it);
+			}
+		});
+		return context;
+	}
+
+	void push(run_queue_task*   task,
+	          Qt::EventPriority priority = Qt::NormalEventPriority) noexcept {
+		task->m_enqueuedAt = m_metrics.enqueued();
+		const auto index = queue_index(priority);
+		auto&      queue = m_queues[index];
+		auto*      head  = queue.load(std::memory_order_relaxed);
+		do {
+			task->m_next = head;
+		// Sequentially consistent, so either wake() sees the eventfd switched
+		// off or stop_eventfd_wakeup() sees the task
+		} while (!queue.compare_exchange_weak(head, task,
+		                                      std::memory_order_seq_cst,
+		                                      std::memory_order_relaxed));
+		if (head == nullptr) {
+			wake(queue_priorities[index]);
+		}
+	}
+
+	// Wakes the thread through an eventfd instead of posted events, for all
+	// schedulers of the thread. The switch takes effect once the thread
+	// processes its events, tasks queued before still run. The queues are
+	// then drained by priority among themselves, but no longer ordered against
+	// other posted events. Returns false where eventfd is not available.
+	//
+	// The thread falls back to posted events when it finishes, the eventfd has
+	// to be enabled again after a restart.
+	auto enable_eventfd_wakeup() -> bool {
+#ifdef Q_OS_LINUX
+		if (m_eventfdRequested.exchange(true, std::memory_order_acq_rel)) {
+			return true;
+		}
+		// Kept open until the context is destroyed, a late wake() may still
+		// write to it after the thread finished
+		if (m_eventfd < 0) {
+			m_eventfd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (m_eventfd < 0) {
+				m_eventfdRequested.store(false, std::memory_order_release);
+				return false;
+			}
+		}
+		// The notifier has to be created on the thread of the context
+		const auto install = [this]() {
+			if (m_notifier) {
+				return;
+			}
+			m_notifier = std::make_unique<QSocketNotifier>(
+			    static_cast<qintptr>(m_eventfd), QSocketNotifier::Read);
+			connect(m_notifier.get(), &QSocketNotifier::activated, this,
+			        &qthread_context::drain_woken);
+			m_eventfdRequested.store(true, std::memory_order_relaxed);
+			m_wakeupFd.store(m_eventfd, std::memory_order_seq_cst);
+		};
+		if (QThread::currentThread() == thread()) {
+			install();
+		} else {
+			QMetaObject::invokeMethod(this, install, Qt::QueuedConnection);
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	[[nodiscard]] auto eventfd_wakeup() const noexcept -> bool {
+		return m_wakeupFd.load(std::memory_order_acquire) >= 0;
+	}
+
+	// Arms a timer, must be called from the thread of the context
+	void add_timer(timer_node* node, clock::time_point deadline,
+	               Qt::TimerType timerType) noexcept {
+		auto& service = m_timers[static_cast<std::size_t>(timerType)];
+		if (service.wheel.empty()) {
+			// The timers of the main thread are stopped when the application quits
+			if (auto* const app = QCoreApplication::instance();
+			    app != nullptr && app->thread() == thread()) {
+				connect(app, &QCoreApplication::aboutToQuit, this,
+				        &qthread_context::cancel_timers, Qt::UniqueConnection);
+			}
+		}
+		service.wheel.insert(node, service.to_tick(m_epoch, deadline));
+		update_timer(service);
+	}
+
+	// Disarms a timer, must be called from the thread of the context. Returns
+	// false if the timer already fired.
+	auto remove_timer(timer_node* node, Qt::TimerType timerType) noexcept
+	    -> bool {
+		auto& service = m_timers[static_cast<std::size_t>(timerType)];
+		if (!service.wheel.remove(node)) {
+			return false;
+		}
+		if (service.wheel.empty()) {
+			service.timer.stop();
+		}
+		return true;
+	}
+
+	[[nodiscard]] auto metrics() noexcept -> metrics_recorder& {
+		return m_metrics;
+	}
+
+protected:
+	auto event(QEvent* ev) -> bool override {
+		if (ev->type() != drain_event::event_type()) {
+			return QObject::event(ev);
+		}
+		auto* const drainEvent  = static_cast<drain_event*>(ev);
+		drainEvent->m_delivered = true;
+		drain(drainEvent->m_priority, false);
+		return true;
+	}
+
+	void timerEvent(QTimerEvent* ev) override {
+		for (auto& service : m_timers) {
+			if (ev->timerId() == service.timer.timerId()) {
+				service.timer.stop();
+				service.wheel.advance(service.to_tick(m_epoch, clock::now(), false));
+				update_timer(service);
+				return;
+			}
+		}
+		QObject::timerEvent(ev);
+	}
+
+private:
+	explicit qthread_context(QThread* thread)
+	    : QObject(nullptr), m_epoch(clock::now()) {
+		moveToThread(thread);
+		connect(thread, &QThread::finished, this, &qthread_context::cancel_timers,
+		        Qt::DirectConnection);
+		connect(thread, &QThread::finished, this,
+		        &qthread_context::stop_eventfd_wakeup, Qt::DirectConnection);
+	}
+
+	void wake(Qt::EventPriority priority) noexcept {
+#ifdef Q_OS_LINUX
+		if (const auto fd = m_wakeupFd.load(std::memory_order_seq_cst); fd >= 0) {
+			const std::uint64_t one = 1;
+			// Only fails when the counter would overflow, the thread is woken then
+			// anyway
+			[[maybe_unused]] const auto written = ::write(fd, &one, sizeof(one));
+			return;
+		}
+#endif
+		QCoreApplication::postEvent(this, new drain_event(this, priority),
+		                            priority);
+	}
+
+	// Called by the notifier of the eventfd
+	void drain_woken() noexcept {
+#ifdef Q_OS_LINUX
+		// Reset the counter before draining, pushes that find an empty queue
+		// afterwards wake the thread again
+		std::uint64_t               count = 0;
+		[[maybe_unused]] const auto read = ::read(m_eventfd, &count, sizeof(count));
+#endif
+		for (const auto priority : {Qt::HighEventPriority, Qt::NormalEventPriority,
+		                            Qt::LowEventPriority}) {
+			drain(priority, false);
+		}
+	}
+
+	// Called when the thread finished. The notifier is registered with the
+	// event dispatcher of the thread and goes away with it, pushes fall back to
+	// posted events, which are kept until the thread runs again.
+	void stop_eventfd_wakeup() noexcept {
+#ifdef Q_OS_LINUX
+		if (m_wakeupFd.exchange(-1, std::memory_order_seq_cst) < 0) {
+			return;
+		}
+		m_notifier.reset();
+		std::uint64_t               count = 0;
+		[[maybe_unused]] const auto read = ::read(m_eventfd, &count, sizeof(count));
+		// Tasks that were woken through the eventfd but did not run yet
+		for (const auto priority : {Qt::HighEventPriority, Qt::NormalEventPriority,
+		                            Qt::LowEventPriority}) {
+			if (m_queues[queue_index(priority)].load(std::memory_order_seq_cst) !=
+			    nullptr) {
+				QCoreApplication::postEvent(this, new drain_event(this, priority),
+				                            priority);
+			}
+		}
+		m_eventfdRequested.store(false, std::memory_order_release);
+#endif
+	}
+
+	struct drain_event : public QEvent {
+		drain_event(qthread_context* context, Qt::EventPriority priority) noexcept
+		    : QEvent(event_type()), m_context(context), m_priority(priority) {}
+
+		drain_event(const drain_event&) = delete;
+		drain_event(drain_event&&)      = delete;
+
+		// Posted events are discarded without delivery when the event loop of the
+		// thread is torn down, the queued tasks are completed as stopped then
+		~drain_event() override {
+			if (!m_delivered) {
+				m_context->drain(m_priority, true);
+			}
+		}
+
+		static auto event_type() noexcept -> QEvent::Type {
+			static const auto type =
+			    static_cast<QEvent::Type>(QEvent::registerEventType());
+			return type;
+		}
+
+		qthread_context* const  m_context;
+		const Qt::EventPriority m_priority;
+		bool                    m_delivered{false};
+	};
+
+	// Qt::LowEventPriority, Qt::NormalEventPriority and Qt::HighEventPriority.
+	// Other priorities are clamped into these, the queues drain with their own
+	// priority whichever priority the first task pushed onto them had.
+	static constexpr std::array<Qt::EventPriority, 3> queue_priorities{
+	    Qt::LowEventPriority, Qt::NormalEventPriority, Qt::HighEventPriority};
+
+	static auto queue_index(Qt::EventPriority priority) noexcept -> std::size_t {
+		return static_cast<std::size_t>(
+		    std::clamp(static_cast<int>(priority), -1, 1) + 1);
+	}
+
+	void drain(Qt::EventPriority priority, bool stopped) noexcept {
+		// The producers push in LIFO order, reverse the batch to run it FIFO
+		run_queue_task* reversed = nullptr;
+		for (auto* task = m_queues[queue_index(priority)].exchange(
+		         nullptr, std::memory_order_acquire);
+		     task != nullptr;) {
+			auto* const next = task->m_next;
+			task->m_next     = reversed;
+			reversed         = task;
+			task             = next;
+		}
+		while (reversed != nullptr) {
+			// The task may be destroyed by its execution
+			auto* const next = reversed->m_next;
+			if (stopped) {
+				m_metrics.dequeued(reversed->m_enqueuedAt);
+			} else {
+				m_metrics.started(reversed->m_enqueuedAt);
+			}
+			reversed->m_execute(reversed, stopped);
+			reversed = next;
+		}
+	}
+
+	void cancel_timers() noexcept {
+		for (auto& service : m_timers) {
+			service.timer.stop();
+			service.wheel.cancel_all();
+		}
+	}
+
+	// Timer wheel and the Qt timer that drives it
+	struct timer_service {
+		timer_service(Qt::TimerType            timerType,
+		              std::chrono::nanoseconds tickResolution) noexcept
+		    : type(timerType), resolution(tickResolution) {}
+
+		// Converts a time point into ticks since the epoch of the context.
+		// Deadlines are rounded up, so timers never fire early.
+		auto to_tick(clock::time_point epoch, clock::time_point time,
+		             bool roundUp = true) const noexcept -> std::uint64_t {
+			const auto elapsed =
+			    std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch)
+			        .count();
+			if (elapsed <= 0) {
+				return 0;
+			}
+			const auto ticks = roundUp
+			                       ? (elapsed + resolution.count() - 1) /
+			                             resolution.count()
+			                       : elapsed / resolution.count();
+			return static_cast<std::uint64_t>(ticks);
+		}
+
+		const Qt::TimerType            type;
+		const std::chrono::nanoseconds resolution;
+		timer_wheel                    wheel;
+		QBasicTimer                    timer;
+		std::uint64_t                  armedTick{0};
+	};
+
+	// Arms the Qt timer for the next event of the wheel. A timer that is armed
+	// earlier is kept, it merely re-arms itself when it fires.
+	void update_timer(timer_service& service) noexcept {
+		const auto next = service.wheel.next_event();
+		if (!next) {
+			service.timer.stop();
+			return;
+		}
+		if (service.timer.isActive() && service.armedTick <= *next) {
+			return;
+		}
+		const auto due =
+		    m_epoch + service.resolution * static_cast<std::int64_t>(*next);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+		const auto interval =
+		    std::chrono::ceil<std::chrono::nanoseconds>(due - clock::now());
+		service.timer.start(std::max(interval, std::chrono::nanoseconds{0}),
+		                    service.type, this);
+#else
+		const auto interval =
+		    std::chrono::ceil<std::chrono::milliseconds>(due - clock::now());
+		service.timer.start(std::max(interval, std::chrono::milliseconds{0}),
+		                    service.type, this);
+#endif
+		service.armedTick = *next;
+	}
+
+	// Precise timers get microsecond ticks where Qt supports sub-millisecond
+	// intervals, the other types tick in milliseconds
+	static constexpr auto precise_resolution =
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+	    std::chrono::nanoseconds{std::chrono::microseconds{1}};
+#else
+	    std::chrono::nanoseconds{std::chrono::milliseconds{1}};
+#endif
+
+	// Indexed by queue_index()
+	std::array<std::atomic<run_queue_task*>, 3> m_queues{};
+	const clock::time_point                     m_epoch;
+	metrics_recorder                            m_metrics;
+	// -1 while events are posted
+	std::atomic<int>                 m_wakeupFd{-1};
+	int                              m_eventfd{-1};
+	std::atomic<bool>                m_eventfdRequested{false};
+	std::unique_ptr<QSocketNotifier> m_notifier;
+	// Indexed by Qt::TimerType
+	std::array<timer_service, 3> m_timers{
+	    timer_service{Qt::PreciseTimer, precise_resolution},
+	    timer_service{Qt::CoarseTimer, std::chrono::milliseconds{1}},
+	    timer_service{Qt::VeryCoarseTimer, std::chrono::milliseconds{1}}};
+};
+} // namespace stdexecutils::qt::detail
+
+#endif // STDEXEC_UTILS_DETAIL_QTHREAD_CONTEXT_HPP
@@ -0,0 +1,369 @@
+#ifndef STDEXEC_UTILS_DETAIL_QTHREAD_GROUP_CONTEXT_HPP
+#define STDEXEC_UTILS_DETAIL_QTHREAD_GROUP_CONTEXT_HPP
+
+#include <stdexecutils/qt/detail/qthread_context.hpp>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEvent>
+#include <QObject>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace stdexecutils::qt::detail {
+
+// Intrusive FIFO of run queue tasks
+struct run_queue_list {
+	void push_back(run_queue_task* task) noexcept {
+		task->m_next = nullptr;
+		if (m_tail != nullptr) {
+			m_tail->m_next = task;
+		} else {
+			m_head = task;
+		}
+		m_tail = task;
+	}
+
+	auto pop_front() noexcept -> run_queue_task* {
+		auto* const task = m_head;
+		if (task != nullptr) {
+			m_head = task->m_next;
+			if (m_head == nullptr) {
+				m_tail = nullptr;
+			}
+		}
+		return task;
+	}
+
+	[[nodiscard]] auto empty() const noexcept -> bool {
+		return m_head == nullptr;
+	}
+
+	run_queue_task* m_head{nullptr};
+	run_queue_task* m_tail{nullptr};
+};
+
+// A group of QThreads that run their own event loop, so work scheduled on them
+// can own QObjects, timers and sockets.
+//
+// Every thread has a local queue and a pinned queue. Tasks of the local queues
+// are stolen by idle threads of the group, pinned tasks always run on the
+// thread they were pushed to. A thread drains its queues in batches and
+// returns to its event loop in between, so its timers and sockets are served
+// while the group is saturated.
+class qthread_group_context {
+public:
+	// Tasks a thread runs before it returns to its event loop
+	static constexpr std::size_t batch_size = 64;
+
+	qthread_group_context(std::size_t threadCount, bool pinThreads) {
+		threadCount = std::max<std::size_t>(threadCount, 1);
+		m_threads.reserve(threadCount);
+		m_workers.reserve(threadCount);
+		for (std::size_t index = 0; index < threadCount; ++index) {
+			m_threads.push_back(std::make_unique<QThread>());
+			m_workers.push_back(
+			    std::make_unique<worker>(*this, index, m_threads.back().get()));
+		}
+		m_idleWorkers.store(threadCount, std::memory_order_relaxed);
+		for (auto& worker : m_workers) {
+			auto* const thread = worker->m_thread;
+			worker->moveToThread(thread);
+			QObject::connect(
+			    thread, &QThread::started, thread,
+			    [worker = worker.get(), pinThreads]() {
+				    current_worker() = worker;
+				    if (pinThreads) {
+					    pin_current_thread(worker->m_index);
+				    }
+			    },
+			    Qt::DirectConnection);
+			thread->start();
+		}
+	}
+
+	qthread_group_context(const qthread_group_context&) = delete;
+	qthread_group_context(qthread_group_context&&)      = delete;
+
+	~qthread_group_context() {
+		for (auto& thread : m_threads) {
+			thread->quit();
+		}
+		for (auto& worker : m_workers) {
+			worker->m_thread->wait();
+			QCoreApplication::removePostedEvents(worker.get(),
+			                                     wake_event::event_type());
+		}
+		// Work that was not started before the threads stopped completes stopped
+		for (auto& worker : m_workers) {
+			while (auto* const task = worker->pop(true)) {
+				task->m_execute(task, true);
+			}
+			while (auto* const task = worker->pop(false)) {
+				task->m_execute(task, true);
+			}
+		}
+	}
+
+	[[nodiscard]] auto size() const noexcept -> std::size_t {
+		return m_workers.size();
+	}
+
+	[[nodiscard]] auto thread(std::size_t index) const noexcept -> QThread* {
+		return m_threads[index].get();
+	}
+
+	// Queued and running tasks of a thread
+	[[nodiscard]] auto load(std::size_t index) const noexcept -> std::size_t {
+		return m_workers[index]->load();
+	}
+
+	// Pushes a task that may run on any thread of the group. Work scheduled
+	// from a thread of the group stays on its local queue, until it is stolen.
+	void push(run_queue_task* task) noexcept {
+		auto* worker = current_worker();
+		if (worker == nullptr || &worker->m_context != this) {
+			worker = m_workers[m_next.fetch_add(1, std::memory_order_relaxed) %
+			                   m_workers.size()]
+			             .get();
+		}
+		worker->push(task, false);
+		if (!worker->wake() &&
+		    m_idleWorkers.load(std::memory_order_acquire) > 0) {
+			// The thread is busy, an idle one steals the task
+			wake_idle_worker(worker->m_index);
+		}
+	}
+
+	// Pushes a task to the pinned queue of the thread with the lowest load
+	auto push_least_loaded(run_queue_task* task) noexcept -> std::size_t {
+		const auto  offset = m_next.fetch_add(1, std::memory_order_relaxed);
+		std::size_t best   = 0;
+		std::size_t lowest = std::numeric_limits<std::size_t>::max();
+		for (std::size_t i = 0; i < m_workers.size(); ++i) {
+			const auto index = (offset + i) % m_workers.size();
+			if (const auto load = m_workers[index]->load(); load < lowest) {
+				best   = index;
+				lowest = load;
+			}
+		}
+		push_pinned(task, best);
+		return best;
+	}
+
+	// Pushes a task that must run on the given thread
+	void push_pinned(run_queue_task* task, std::size_t index) noexcept {
+		auto& worker = *m_workers[index];
+		worker.push(task, true);
+		worker.wake();
+	}
+
+private:
+	class worker;
+
+	struct wake_event : public QEvent {
+		wake_event() noexcept : QEvent(event_type()) {}
+
+		static auto event_type() noexcept -> QEvent::Type {
+			static const auto type =
+			    static_cast<QEvent::Type>(QEvent::registerEventType());
+			return type;
+		}
+	};
+
+	class worker : public QObject {
+	public:
+		worker(qthread_group_context& context, std::size_t index,
+		       QThread* thread)
+		    : QObject(nullptr), m_context(context), m_index(index),
+		      m_thread(thread) {}
+
+		worker(const worker&) = delete;
+		worker(worker&&)      = delete;
+
+		~worker() override = default;
+
+		void push(run_queue_task* task, bool pinned) noexcept {
+			const std::lock_guard lock(m_mutex);
+			(pinned ? m_pinned : m_local).push_back(task);
+			m_queued.fetch_add(1, std::memory_order_seq_cst);
+			if (!pinned) {
+				m_stealable.fetch_add(1, std::memory_order_seq_cst);
+			}
+		}
+
+		auto pop(bool pinned) noexcept -> run_queue_task* {
+			const std::lock_guard lock(m_mutex);
+			auto* const           task = (pinned ? m_pinned : m_local).pop_front();
+			if (task != nullptr) {
+				m_queued.fetch_sub(1, std::memory_order_relaxed);
+				if (!pinned) {
+					m_stealable.fetch_sub(1, std::memory_order_relaxed);
+				}
+			}
+			return task;
+		}
+
+		[[nodiscard]] auto load() const noexcept -> std::size_t {
+			return m_queued.load(std::memory_order_relaxed) +
+			       (m_running.load(std::memory_order_relaxed) ? 1 : 0);
+		}
+
+		// Schedules a run of the thread, returns false if one is already pending
+		// or running
+		auto wake() noexcept -> bool {
+			if (m_awake.exchange(true, std::memory_order_acq_rel)) {
+				return false;
+			}
+			m_context.m_idleWorkers.fetch_sub(1, std::memory_order_acq_rel);
+			QCoreApplication::postEvent(this, new wake_event());
+			return true;
+		}
+
+		[[nodiscard]] auto awake() const noexcept -> bool {
+			return m_awake.load(std::memory_order_acquire);
+		}
+
+		qthread_group_context& m_context;
+		const std::size_t      m_index;
+		QThread* const         m_thread;
+
+	protected:
+		auto event(QEvent* ev) -> bool override {
+			if (ev->type() != wake_event::event_type()) {
+				return QObject::event(ev);
+			}
+			m_context.run(*this);
+			return true;
+		}
+
+	private:
+		std::mutex               m_mutex;
+		run_queue_list           m_pinned;
+		run_queue_list           m_local;
+		std::atomic<std::size_t> m_queued{0};
+		std::atomic<std::size_t> m_stealable{0};
+		std::atomic<bool>        m_running{false};
+		std::atomic<bool>        m_awake{false};
+
+		friend class qthread_group_context;
+	};
+
+	static auto current_worker() noexcept -> worker*& {
+		thread_local worker* current = nullptr;
+		return current;
+	}
+
+	// Binds the thread to the index-th CPU the process may run on, counted
+	// modulo their number. A failure leaves the thread unpinned with a warning.
+	static void pin_current_thread([[maybe_unused]] std::size_t index) noexcept {
+#ifdef Q_OS_LINUX
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		int error = 0;
+		if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+			error = errno;
+		} else {
+			const auto count = static_cast<std::size_t>(CPU_COUNT(&allowed));
+			auto       nth   = index % std::max<std::size_t>(count, 1);
+			int        cpu   = 0;
+			for (; cpu < CPU_SETSIZE; ++cpu) {
+				if (CPU_ISSET(cpu, &allowed) && nth-- == 0) {
+					break;
+				}
+			}
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(cpu, &set);
+			error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+		}
+		if (error != 0) {
+			qWarning("QThreadGroup: could not pin thread %zu: %s", index,
+			         std::strerror(error));
+		}
+#endif
+	}
+
+	// Own pinned tasks first, then own local tasks, then the oldest local task
+	// of another thread
+	auto next_task(worker& self) noexcept -> run_queue_task* {
+		if (auto* const task = self.pop(true)) {
+			return task;
+		}
+		if (auto* const task = self.pop(false)) {
+			return task;
+		}
+		for (std::size_t i = 1; i < m_workers.size(); ++i) {
+			auto& victim = *m_workers[(self.m_index + i) % m_workers.size()];
+			if (auto* const task = victim.pop(false)) {
+				return task;
+			}
+		}
+		return nullptr;
+	}
+
+	void run(worker& self) noexcept {
+		for (std::size_t count = 0; count < batch_size; ++count) {
+			auto* const task = next_task(self);
+			if (task == nullptr) {
+				self.m_running.store(false, std::memory_order_relaxed);
+				m_idleWorkers.fetch_add(1, std::memory_order_acq_rel);
+				self.m_awake.store(false, std::memory_order_seq_cst);
+				// Work pushed while the queues were checked did not wake the thread
+				if (has_work(self)) {
+					self.wake();
+				}
+				return;
+			}
+			self.m_running.store(true, std::memory_order_relaxed);
+			task->m_execute(task, false);
+		}
+		// The batch is exhausted, other events of the thread go first
+		QCoreApplication::postEvent(&self, new wake_event());
+	}
+
+	auto has_work(const worker& self) noexcept -> bool {
+		if (self.m_queued.load(std::memory_order_seq_cst) > 0) {
+			return true;
+		}
+		for (const auto& worker : m_workers) {
+			if (worker->m_stealable.load(std::memory_order_seq_cst) > 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void wake_idle_worker(std::size_t busy) noexcept {
+		for (std::size_t i = 1; i < m_workers.size(); ++i) {
+			auto& candidate = *m_workers[(busy + i) % m_workers.size()];
+			if (!candidate.awake() && candidate.wake()) {
+				return;
+			}
+		}
+	}
+
+	// The threads outlive their workers
+	std::vector<std::unique_ptr<QThread>> m_threads;
+	std::vector<std::unique_ptr<worker>>  m_workers;
+	std::atomic<std::size_t>              m_next{0};
+	std::atomic<std::size_t>              m_idleWorkers{0};
+};
+} // namespace stdexecutils::qt::detail
+
+#endif // STDEXEC_UTILS_DETAIL_QTHREAD_GROUP_CONTEXT_HPP
@@ -0,0 +1,128 @@
+#ifndef STDEXEC_UTILS_DETAIL_SIZE_CLASS_POOL_HPP
+#define STDEXEC_UTILS_DETAIL_SIZE_CLASS_POOL_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <new>
+
+namespace stdexecutils::qt::detail {
+
+// Per-thread cache of freed blocks, sorted into power-of-two size classes from
+// 64 bytes to 4 KiB. Larger blocks go straight to operator new. A block freed
+// on another thread than the one it was allocated on joins the cache of the
+// freeing thread.
+class size_class_pool {
+public:
+	static constexpr std::size_t min_size   = 64;
+	static constexpr std::size_t max_size   = 4096;
+	static constexpr std::size_t classes    = 7;
+	static constexpr std::size_t max_cached = 64; // Blocks kept per class
+
+	size_class_pool() = default;
+
+	size_class_pool(const size_class_pool&) = delete;
+	size_class_pool(size_class_pool&&)      = delete;
+
+	~size_class_pool() {
+		for (auto& list : m_free) {
+			while (list.head != nullptr) {
+				auto* const block = list.head;
+				list.head         = block->next;
+				::operator delete(block);
+			}
+		}
+	}
+
+	static auto local() noexcept -> size_class_pool& {
+		thread_local size_class_pool pool;
+		return pool;
+	}
+
+	auto allocate(std::size_t size) -> void* {
+		if (size > max_size) {
+			return ::operator new(size);
+		}
+		auto& list = m_free[class_index(size)];
+		if (list.head == nullptr) {
+			return ::operator new(class_size(class_index(size)));
+		}
+		auto* const block = list.head;
+		list.head         = block->next;
+		--list.count;
+		return block;
+	}
+
+	void deallocate(void* pointer, std::size_t size) noexcept {
+		if (size > max_size) {
+			::operator delete(pointer);
+			return;
+		}
+		auto& list = m_free[class_index(size)];
+		if (list.count == max_cached) {
+			::operator delete(pointer);
+			return;
+		}
+		list.head = new (pointer) block{list.head};
+		++list.count;
+	}
+
+	static constexpr auto class_index(std::size_t size) noexcept -> std::size_t {
+		return size <= min_size ? 0
+		                        : static_cast<std::size_t>(std::bit_width(size - 1)) -
+		                              std::bit_width(min_size - 1);
+	}
+
+	static constexpr auto class_size(std::size_t index) noexcept -> std::size_t {
+		return min_size << index;
+	}
+
+private:
+	struct block {
+		block* next;
+	};
+
+	struct free_list {
+		block*      head{nullptr};
+		std::size_t count{0};
+	};
+
+	std::array<free_list, classes> m_free{};
+};
+
+// Allocator of the per-thread size class pool
+template <class T>
+struct pool_allocator {
+	using value_type = T;
+
+	pool_allocator() noexcept = default;
+
+	template <class U>
+	pool_allocator(const pool_allocator<U>& /*other*/) noexcept {}
+
+	auto allocate(std::size_t n) -> T* {
+		if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+			return static_cast<T*>(::operator new(
+			    n * sizeof(T), std::align_val_t{alignof(T)}));
+		} else {
+			return static_cast<T*>(size_class_pool::local().allocate(n * sizeof(T)));
+		}
+	}
+
+	void deallocate(T* pointer, std::size_t n) noexcept {
+		if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+			::operator delete(pointer, std::align_val_t{alignof(T)});
+		} else {
+			size_class_pool::local().deallocate(pointer, n * sizeof(T));
+		}
+	}
+
+	template <class U>
+	auto operator==(const pool_allocator<U>& /*other*/) const noexcept -> bool {
+		return true;
+	}
+};
+
+} // namespace stdexecutils::qt::detail
+
+#endif // STDEXEC_UTILS_DETAIL_SIZE_CLASS_POOL_HPP
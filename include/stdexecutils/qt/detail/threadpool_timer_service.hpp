@@ -0,0 +1,109 @@
+#ifndef STDEXEC_UTILS_DETAIL_THREADPOOL_TIMER_SERVICE_HPP
+#define STDEXEC_UTILS_DETAIL_THREADPOOL_TIMER_SERVICE_HPP
+
+#include <stdexecutils/qt/detail/timer_wheel.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace stdexecutils::qt::detail {
+
+// Process wide timer service of the QThreadPool scheduler. A single thread
+// sleeps until the next deadline of a timer wheel, expired timers are fired
+// on that thread, which submits their runnables straight to the pool.
+//
+// The fire callbacks run while the service is locked, they must only submit
+// work and not complete receivers.
+class threadpool_timer_service {
+public:
+	using clock = std::chrono::steady_clock;
+
+	threadpool_timer_service(const threadpool_timer_service&) = delete;
+	threadpool_timer_service(threadpool_timer_service&&)      = delete;
+
+	~threadpool_timer_service() {
+		{
+			const std::lock_guard lock(m_mutex);
+			m_stopping = true;
+		}
+		m_wakeup.notify_one();
+		m_thread.join();
+		// The service thread is gone, nothing can fire concurrently anymore
+		m_wheel.cancel_all();
+	}
+
+	static auto instance() -> threadpool_timer_service& {
+		static threadpool_timer_service service;
+		return service;
+	}
+
+	[[nodiscard]] auto now() const noexcept -> clock::time_point {
+		return clock::now();
+	}
+
+	void add(timer_node* node, clock::time_point deadline) noexcept {
+		const std::lock_guard lock(m_mutex);
+		const auto            previous = m_wheel.next_event();
+		m_wheel.insert(node, to_tick(deadline, true));
+		if (m_wheel.next_event() != previous) {
+			m_wakeup.notify_one();
+		}
+	}
+
+	// Returns false if the timer already fired
+	auto remove(timer_node* node) noexcept -> bool {
+		const std::lock_guard lock(m_mutex);
+		return m_wheel.remove(node);
+	}
+
+private:
+	threadpool_timer_service()
+	    : m_epoch(clock::now()), m_thread([this]() { run(); }) {}
+
+	void run() {
+#ifdef __linux__
+		// Shown in debuggers and names the thread in traces
+		pthread_setname_np(pthread_self(), "Timer service");
+#endif
+		std::unique_lock lock(m_mutex);
+		while (!m_stopping) {
+			m_wheel.advance(to_tick(clock::now(), false));
+			if (const auto next = m_wheel.next_event()) {
+				const auto due =
+				    m_epoch + std::chrono::milliseconds(
+				                  static_cast<std::chrono::milliseconds::rep>(*next));
+				m_wakeup.wait_until(lock, due);
+			} else {
+				m_wakeup.wait(lock);
+			}
+		}
+	}
+
+	// The wheel ticks in milliseconds since the creation of the service
+	auto to_tick(clock::time_point time, bool roundUp) const noexcept
+	    -> std::uint64_t {
+		const auto elapsed = time - m_epoch;
+		const auto ticks =
+		    roundUp ? std::chrono::ceil<std::chrono::milliseconds>(elapsed).count()
+		            : std::chrono::floor<std::chrono::milliseconds>(elapsed).count();
+		return ticks < 0 ? 0 : static_cast<std::uint64_t>(ticks);
+	}
+
+	const clock::time_point m_epoch;
+	std::mutex              m_mutex;
+	std::condition_variable m_wakeup;
+	timer_wheel             m_wheel;
+	bool                    m_stopping{false};
+	std::thread             m_thread;
+};
+
+} // namespace stdexecutils::qt::detail
+
+#endif // STDEXEC_UTILS_DETAIL_THREADPOOL_TIMER_SERVICE_HPP
@@ -0,0 +1,234 @@
+#ifndef STDEXEC_UTILS_DETAIL_TIMER_WHEEL_HPP
+#define STDEXEC_UTILS_DETAIL_TIMER_WHEEL_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace stdexecutils::qt::detail {
+
+// Intrusive node of the timer wheel, operation states derive from it so
+// arming a timer does not allocate.
+struct timer_node {
+	using fire_fn = void (*)(timer_node*, bool stopped) noexcept;
+
+	explicit timer_node(fire_fn fire) noexcept : m_fire(fire) {}
+
+	timer_node*   m_prev{nullptr};
+	timer_node*   m_next{nullptr};
+	std::uint64_t m_expiry{0};
+	fire_fn       m_fire;
+	std::uint8_t  m_level{0};
+	std::uint8_t  m_slot{0};
+	bool          m_linked{false};
+};
+
+// Hierarchical timing wheel with O(1) insert and cancel. Time is measured in
+// abstract ticks, timers expire when the wheel is advanced past their expiry.
+// Four levels of 64 slots cover 2^24 ticks, timers further in the future are
+// kept in an overflow list that is redistributed once per full revolution.
+class timer_wheel {
+public:
+	static constexpr unsigned      slot_bits  = 6;
+	static constexpr unsigned      slot_count = 1U << slot_bits;
+	static constexpr unsigned      levels     = 4;
+	static constexpr std::uint64_t slot_mask  = slot_count - 1;
+
+	timer_wheel() = default;
+
+	timer_wheel(const timer_wheel&) = delete;
+	timer_wheel(timer_wheel&&)      = delete;
+
+	// Last tick that has been processed
+	[[nodiscard]] auto current() const noexcept -> std::uint64_t {
+		return m_current;
+	}
+
+	[[nodiscard]] auto empty() const noexcept -> bool { return m_size == 0; }
+
+	[[nodiscard]] auto size() const noexcept -> std::size_t { return m_size; }
+
+	// Timers that are already due expire with the next processed tick
+	void insert(timer_node* node, std::uint64_t expiry) noexcept {
+		node->m_expiry = std::max(expiry, m_current + 1);
+		place(node);
+		++m_size;
+	}
+
+	// Returns false if the node was not armed, i.e. it already expired
+	auto remove(timer_node* node) noexcept -> bool {
+		if (!node->m_linked) {
+			return false;
+		}
+		unlink(node);
+		--m_size;
+		return true;
+	}
+
+	// Smallest tick at which advancing the wheel has an effect, either because
+	// timers expire or because a slot of a higher level is redistributed
+	[[nodiscard]] auto next_event() const noexcept
+	    -> std::optional<std::uint64_t> {
+		std::optional<std::uint64_t> next;
+		for (unsigned level = 0; level < levels; ++level) {
+			const auto shift = level * slot_bits;
+			const auto index = (m_current >> shift) & slot_mask;
+			const auto ahead =
+			    index == slot_mask ? 0 : m_occupied[level] >> (index + 1)
+			                                 << (index + 1);
+			if (ahead == 0) {
+				continue;
+			}
+			const auto slot  = static_cast<std::uint64_t>(std::countr_zero(ahead));
+			const auto block = m_current >> (shift + slot_bits) << (shift + slot_bits);
+			const auto tick  = block + (slot << shift);
+			next             = next ? std::min(*next, tick) : tick;
+		}
+		if (m_overflow != nullptr) {
+			constexpr auto span = std::uint64_t{1} << (levels * slot_bits);
+			const auto     tick = (m_current / span + 1) * span;
+			next                = next ? std::min(*next, tick) : tick;
+		}
+		return next;
+	}
+
+	// Processes all ticks up to and including `now` and fires every expired
+	// timer with `fire(node, false)`
+	void advance(std::uint64_t now) noexcept {
+		while (const auto next = next_event()) {
+			if (*next > now) {
+				break;
+			}
+			process(*next);
+		}
+		m_current = std::max(m_current, now);
+	}
+
+	// Removes all timers and fires them with `fire(node, true)`
+	void cancel_all() noexcept {
+		const auto fire_all = [this](timer_node*& head) {
+			while (head != nullptr) {
+				auto* const node = head;
+				unlink(node);
+				--m_size;
+				node->m_fire(node, true);
+			}
+		};
+		for (auto& level : m_slots) {
+			for (auto& head : level) {
+				fire_all(head);
+			}
+		}
+		fire_all(m_overflow);
+	}
+
+private:
+	void place(timer_node* node) noexcept {
+		const auto diff = node->m_expiry ^ m_current;
+		const auto level =
+		    diff == 0 ? 0U
+		              : static_cast<unsigned>(std::bit_width(diff) - 1) / slot_bits;
+		if (level >= levels) {
+			link(node, m_overflow, levels, 0);
+			return;
+		}
+		const auto slot = static_cast<std::uint8_t>(
+		    (node->m_expiry >> (level * slot_bits)) & slot_mask);
+		link(node, m_slots[level][slot], static_cast<std::uint8_t>(level), slot);
+		m_occupied[level] |= std::uint64_t{1} << slot;
+	}
+
+	void link(timer_node* node, timer_node*& head, std::uint8_t level,
+	          std::uint8_t slot) noexcept {
+		node->m_level  = level;
+		node->m_slot   = slot;
+		node->m_prev   = nullptr;
+		node->m_next   = head;
+		node->m_linked = true;
+		if (head != nullptr) {
+			head->m_prev = node;
+		}
+		head = node;
+	}
+
+	void unlink(timer_node* node) noexcept {
+		auto& head = node->m_level == levels
+		                 ? m_overflow
+		                 : m_slots[node->m_level][node->m_slot];
+		if (node->m_prev != nullptr) {
+			node->m_prev->m_next = node->m_next;
+		} else {
+			head = node->m_next;
+		}
+		if (node->m_next != nullptr) {
+			node->m_next->m_prev = node->m_prev;
+		}
+		if (head == nullptr && node->m_level < levels) {
+			m_occupied[node->m_level] &= ~(std::uint64_t{1} << node->m_slot);
+		}
+		node->m_prev   = nullptr;
+		node->m_next   = nullptr;
+		node->m_linked = false;
+	}
+
+	// Detaches the list of a slot for redistribution
+	auto take(timer_node*& head, unsigned level, std::uint64_t slot) noexcept
+	    -> timer_node* {
+		auto* const list = head;
+		head             = nullptr;
+		if (level < levels) {
+			m_occupied[level] &= ~(std::uint64_t{1} << slot);
+		}
+		return list;
+	}
+
+	void redistribute(timer_node* list) noexcept {
+		while (list != nullptr) {
+			auto* const next = list->m_next;
+			list->m_linked   = false;
+			place(list);
+			list = next;
+		}
+	}
+
+	void process(std::uint64_t tick) noexcept {
+		m_current = tick;
+
+		// Higher levels first, so that their timers can cascade all the way down
+		constexpr auto span = std::uint64_t{1} << (levels * slot_bits);
+		if (tick % span == 0) {
+			redistribute(take(m_overflow, levels, 0));
+		}
+		for (unsigned level = levels - 1; level > 0; --level) {
+			const auto shift = level * slot_bits;
+			if ((tick & ((std::uint64_t{1} << shift) - 1)) != 0) {
+				continue;
+			}
+			const auto slot = (tick >> shift) & slot_mask;
+			redistribute(take(m_slots[level][slot], level, slot));
+		}
+
+		// Timers are unlinked one at a time, so that fire callbacks can cancel
+		// timers of the same slot. New timers never land in the processed slot.
+		auto& head = m_slots[0][tick & slot_mask];
+		while (head != nullptr) {
+			auto* const node = head;
+			unlink(node);
+			--m_size;
+			node->m_fire(node, false);
+		}
+	}
+
+	std::array<std::array<timer_node*, slot_count>, levels> m_slots{};
+	std::array<std::uint64_t, levels>                       m_occupied{};
+	timer_node*                                             m_overflow{nullptr};
+	std::uint64_t                                           m_current{0};
+	std::size_t                                             m_size{0};
+};
+
+} // namespace stdexecutils::qt::detail
+
+#endif // STDEXEC_UTILS_DETAIL_TIMER_WHEEL_HPP
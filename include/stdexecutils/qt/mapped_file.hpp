@@ -0,0 +1,342 @@
+#ifndef STDEXEC_UTILS_MAPPED_FILE_HPP
+#define STDEXEC_UTILS_MAPPED_FILE_HPP
+
+#include <stdexecutils/qt/qiodevice.hpp>
+
+#include <QFile>
+#include <QString>
+#include <QThread>
+
+#ifndef Q_MOC_RUN
+#include <exec/sequence_senders.hpp>
+#include <stdexec/execution.hpp>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace stdexecutils::qt {
+
+// View of a chunk of a memory-mapped file. It is valid until the sender that
+// produced it completes, the mapping is released then.
+struct file_chunk {
+	// Position of the chunk in the file
+	std::size_t                index{0};
+	std::uint64_t              offset{0};
+	std::span<const std::byte> data;
+};
+
+namespace detail {
+
+// Read-only mapping of a whole file, split into chunks of a fixed size. The
+// pages are only read when a chunk is touched, and the mapping is released
+// with the object.
+class mapped_file {
+public:
+	mapped_file(const QString& path, std::size_t chunkSize)
+	    : m_file(path), m_chunkSize(std::max(chunkSize, std::size_t{1})) {
+		if (!m_file.open(QIODevice::ReadOnly)) {
+			throw io_error(m_file.errorString().toStdString());
+		}
+		m_size = static_cast<std::uint64_t>(m_file.size());
+		// Empty files can't be mapped, they have no chunks
+		if (m_size > 0) {
+			m_data = m_file.map(0, m_file.size());
+			if (m_data == nullptr) {
+				throw io_error(m_file.errorString().toStdString());
+			}
+		}
+	}
+
+	mapped_file(const mapped_file&) = delete;
+	mapped_file(mapped_file&&)      = delete;
+
+	~mapped_file() {
+		if (m_data != nullptr) {
+			m_file.unmap(m_data);
+		}
+	}
+
+	[[nodiscard]] auto chunk_count() const noexcept -> std::size_t {
+		return static_cast<std::size_t>((m_size + m_chunkSize - 1) / m_chunkSize);
+	}
+
+	[[nodiscard]] auto chunk(std::size_t index) const noexcept -> file_chunk {
+		const auto offset = static_cast<std::uint64_t>(index) * m_chunkSize;
+		const auto size   = std::min<std::uint64_t>(m_chunkSize, m_size - offset);
+		return {index, offset,
+		        std::span<const std::byte>(
+		            reinterpret_cast<const std::byte*>(m_data + offset),
+		            static_cast<std::size_t>(size))};
+	}
+
+private:
+	QFile             m_file;
+	const std::size_t m_chunkSize;
+	std::uint64_t     m_size{0};
+	uchar*            m_data{nullptr};
+};
+
+// Chunks in flight by default: a chunk per thread of the pool
+template <class Scheduler>
+auto default_max_in_flight(const Scheduler& scheduler) -> std::size_t {
+	if constexpr (requires { scheduler.pool()->maxThreadCount(); }) {
+		return static_cast<std::size_t>(
+		    std::max(scheduler.pool()->maxThreadCount(), 1));
+	} else {
+		return static_cast<std::size_t>(std::max(QThread::idealThreadCount(), 1));
+	}
+}
+
+template <class Scheduler>
+using chunk_item_sender = decltype(stdexec::starts_on(
+    std::declval<Scheduler>(), stdexec::just(std::declval<file_chunk>())));
+
+// Operation state of mapped_file_chunks. The file is mapped on start, then up
+// to maxInFlight items are started on the scheduler. Each slot starts the
+// next chunk when its item is done, the last slot releases the mapping and
+// completes the sequence.
+template <class Scheduler, class Recv>
+class mapped_chunks_op_state {
+public:
+	mapped_chunks_op_state(Recv&& receiver, Scheduler scheduler, QString path,
+	                       std::size_t chunkSize, std::size_t maxInFlight)
+	    : m_receiver(std::move(receiver)), m_scheduler(std::move(scheduler)),
+	      m_path(std::move(path)), m_chunkSize(chunkSize),
+	      m_maxInFlight(std::max(maxInFlight, std::size_t{1})) {}
+
+	mapped_chunks_op_state(const mapped_chunks_op_state&) = delete;
+	mapped_chunks_op_state(mapped_chunks_op_state&&)      = delete;
+
+	void start() noexcept {
+		if (stdexec::get_stop_token(stdexec::get_env(m_receiver))
+		        .stop_requested()) {
+			stdexec::set_stopped(std::move(m_receiver));
+			return;
+		}
+		std::size_t window = 0;
+		try {
+			m_file.emplace(m_path, m_chunkSize);
+			window  = std::min(m_file->chunk_count(), m_maxInFlight);
+			m_slots = std::make_unique<slot[]>(window);
+		} catch (...) {
+			m_file.reset();
+			stdexec::set_error(std::move(m_receiver), std::current_exception());
+			return;
+		}
+		if (window == 0) {
+			finish();
+			return;
+		}
+		// Slots that did not start yet count as active, so none of the started
+		// ones can complete the sequence meanwhile
+		m_active.store(window, std::memory_order_relaxed);
+		for (std::size_t index = 0; index < window; ++index) {
+			m_slots[index].m_opState = this;
+			start_next(m_slots[index]);
+		}
+	}
+
+private:
+	struct slot;
+
+	struct item_receiver {
+		using __id = item_receiver;
+		using __t  = item_receiver;
+
+		using receiver_concept = stdexec::receiver_t;
+
+		void set_value() noexcept { m_slot->m_opState->start_next(*m_slot); }
+
+		// The receiver can't take more items, the sequence ends
+		template <class Error>
+		void set_error(Error&& /*error*/) noexcept {
+			m_slot->m_opState->end_slot(true);
+		}
+
+		void set_stopped() noexcept { m_slot->m_opState->end_slot(true); }
+
+		[[nodiscard]] auto get_env() const noexcept -> stdexec::env_of_t<Recv> {
+			return stdexec::get_env(m_slot->m_opState->m_receiver);
+		}
+
+		slot* m_slot;
+	};
+
+	using next_sender = decltype(exec::set_next(
+	    std::declval<Recv&>(), std::declval<chunk_item_sender<Scheduler>>()));
+	using item_op_state = stdexec::connect_result_t<next_sender, item_receiver>;
+
+	struct slot {
+		mapped_chunks_op_state*      m_opState{nullptr};
+		std::optional<item_op_state> m_item;
+	};
+
+	// Replaces the item of the slot with the next chunk, called from the
+	// completion of the previous item
+	void start_next(slot& current) noexcept {
+		const auto index = m_next.fetch_add(1, std::memory_order_relaxed);
+		if (index >= m_file->chunk_count() ||
+		    m_ended.load(std::memory_order_relaxed) ||
+		    stdexec::get_stop_token(stdexec::get_env(m_receiver))
+		        .stop_requested()) {
+			end_slot(false);
+			return;
+		}
+		try {
+			current.m_item.emplace(stdexec::__conv{[&]() {
+				return stdexec::connect(
+				    exec::set_next(m_receiver,
+				                   stdexec::starts_on(m_scheduler,
+				                                      stdexec::just(
+				                                          m_file->chunk(index)))),
+				    item_receiver{&current});
+			}});
+		} catch (...) {
+			if (!m_failed.exchange(true, std::memory_order_relaxed)) {
+				m_error = std::current_exception();
+			}
+			end_slot(true);
+			return;
+		}
+		stdexec::start(*current.m_item);
+	}
+
+	void end_slot(bool ended) noexcept {
+		if (ended) {
+			m_ended.store(true, std::memory_order_relaxed);
+		}
+		if (m_active.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			finish();
+		}
+	}
+
+	void finish() noexcept {
+		// All items are done, the views into the mapping are no longer used
+		m_file.reset();
+		if (m_failed.load(std::memory_order_relaxed)) {
+			stdexec::set_error(std::move(m_receiver), std::move(m_error));
+		} else if (stdexec::get_stop_token(stdexec::get_env(m_receiver))
+		               .stop_requested()) {
+			stdexec::set_stopped(std::move(m_receiver));
+		} else {
+			stdexec::set_value(std::move(m_receiver));
+		}
+	}
+
+	Recv                       m_receiver;
+	Scheduler                  m_scheduler;
+	const QString              m_path;
+	const std::size_t          m_chunkSize;
+	const std::size_t          m_maxInFlight;
+	std::optional<mapped_file> m_file;
+	std::unique_ptr<slot[]>    m_slots;
+	std::atomic<std::size_t>   m_next{0};
+	std::atomic<std::size_t>   m_active{0};
+	std::atomic<bool>          m_ended{false};
+	std::atomic<bool>          m_failed{false};
+	std::exception_ptr         m_error;
+};
+
+template <class Scheduler>
+struct mapped_chunks_sender {
+	using __id = mapped_chunks_sender;
+	using __t  = mapped_chunks_sender;
+
+	using sender_concept        = exec::sequence_sender_t;
+	using completion_signatures = stdexec::completion_signatures< //
+	    stdexec::set_value_t(),                                   //
+	    stdexec::set_error_t(std::exception_ptr),                 //
+	    stdexec::set_stopped_t()>;
+	using item_types = exec::item_types<chunk_item_sender<Scheduler>>;
+
+	mapped_chunks_sender(Scheduler scheduler, QString path,
+	                     std::size_t chunkSize, std::size_t maxInFlight)
+	    : m_scheduler(std::move(scheduler)), m_path(std::move(path)),
+	      m_chunkSize(chunkSize), m_maxInFlight(maxInFlight) {}
+
+	template <class R>
+	friend auto tag_invoke(exec::subscribe_t, mapped_chunks_sender self, R r)
+	    -> mapped_chunks_op_state<Scheduler, R> {
+		return mapped_chunks_op_state<Scheduler, R>(
+		    std::move(r), std::move(self.m_scheduler), std::move(self.m_path),
+		    self.m_chunkSize, self.m_maxInFlight);
+	}
+
+	auto get_env() const noexcept -> stdexec::empty_env { return {}; }
+
+private:
+	Scheduler   m_scheduler;
+	QString     m_path;
+	std::size_t m_chunkSize;
+	std::size_t m_maxInFlight;
+};
+} // namespace detail
+
+// Sequence sender that maps a file with QFile::map and yields it as
+// file_chunk views of chunkSize bytes, the last one may be shorter. Nothing is
+// copied, the pages are read as the chunks are touched.
+//
+// Every item is started on the scheduler, up to maxInFlight at a time (by
+// default a chunk per thread of the pool), so the chunks are processed in
+// parallel and complete in any order. The mapping is released once every
+// item is done, before the sequence completes. Errors of opening or mapping
+// the file are passed on as io_error.
+template <stdexec::scheduler Scheduler>
+auto mapped_file_chunks(Scheduler scheduler, QString path,
+                        std::size_t chunkSize, std::size_t maxInFlight = 0)
+    -> detail::mapped_chunks_sender<Scheduler> {
+	if (maxInFlight == 0) {
+		maxInFlight = detail::default_max_in_flight(scheduler);
+	}
+	return {std::move(scheduler), std::move(path), chunkSize, maxInFlight};
+}
+
+// Maps a file and calls fun(file_chunk) for its chunks in parallel on the
+// scheduler, fun is called concurrently. Completes with the results in the
+// order of the chunks in the file, the mapping is released before.
+//
+// On the QThreadPool scheduler the chunks are spread over the pool like
+// stdexec::bulk.
+template <stdexec::scheduler Scheduler, class Fun>
+    requires std::invocable<const Fun&, const file_chunk&> &&
+             std::default_initializable<std::decay_t<
+                 std::invoke_result_t<const Fun&, const file_chunk&>>>
+auto transform_mapped_file(Scheduler scheduler, QString path,
+                           std::size_t chunkSize, Fun fun) {
+	using result_type =
+	    std::decay_t<std::invoke_result_t<const Fun&, const file_chunk&>>;
+	using file_ptr = std::unique_ptr<detail::mapped_file>;
+	return stdexec::schedule(scheduler) |
+	       stdexec::then([path = std::move(path), chunkSize]() {
+		       return std::make_unique<detail::mapped_file>(path, chunkSize);
+	       }) |
+	       stdexec::let_value([scheduler, fun = std::move(fun)](file_ptr& file) {
+		       const auto count = file->chunk_count();
+		       return stdexec::just(std::vector<result_type>(count)) |
+		              stdexec::continues_on(scheduler) |
+		              stdexec::bulk(count,
+		                            [&file, &fun](std::size_t               index,
+		                                          std::vector<result_type>& results) {
+			                            results[index] = fun(file->chunk(index));
+		                            }) |
+		              stdexec::then([&file](std::vector<result_type>&& results) {
+			              file.reset();
+			              return std::move(results);
+		              });
+	       });
+}
+
+} // namespace stdexecutils::qt
+
+#endif // STDEXEC_UTILS_MAPPED_FILE_HPP
@@ -0,0 +1,119 @@
+#ifndef STDEXEC_UTILS_METRICS_HPP
+#define STDEXEC_UTILS_METRICS_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace stdexecutils::qt {
+namespace detail {
+class histogram_recorder;
+} // namespace detail
+
+// Distribution of durations. Values are counted in log-linear buckets, like
+// an HDR histogram: exact below 8 ns and within 1/8 of the value above, up to
+// 2^41 ns (about 36 minutes). Longer durations count as the largest bucket.
+class duration_histogram {
+public:
+	static constexpr unsigned    sub_bucket_bits = 3;
+	static constexpr unsigned    max_exponent    = 40;
+	static constexpr std::size_t bucket_count =
+	    (max_exponent - sub_bucket_bits + 2) << sub_bucket_bits;
+
+	[[nodiscard]] static constexpr auto bucket_index(std::uint64_t nanoseconds)
+	    -> std::size_t {
+		constexpr auto linear = std::uint64_t{1} << sub_bucket_bits;
+		nanoseconds =
+		    std::min(nanoseconds, (std::uint64_t{2} << max_exponent) - 1);
+		if (nanoseconds < linear) {
+			return static_cast<std::size_t>(nanoseconds);
+		}
+		const auto exponent =
+		    static_cast<unsigned>(std::bit_width(nanoseconds)) - 1;
+		const auto sub =
+		    (nanoseconds >> (exponent - sub_bucket_bits)) & (linear - 1);
+		return static_cast<std::size_t>(
+		    ((exponent - sub_bucket_bits + 1) << sub_bucket_bits) + sub);
+	}
+
+	// Largest value counted in a bucket
+	[[nodiscard]] static constexpr auto bucket_limit(std::size_t index)
+	    -> std::uint64_t {
+		constexpr auto linear = std::size_t{1} << sub_bucket_bits;
+		if (index < linear) {
+			return index;
+		}
+		const auto exponent =
+		    static_cast<unsigned>(index >> sub_bucket_bits) + sub_bucket_bits - 1;
+		const auto lower = (linear + (index & (linear - 1)))
+		                   << (exponent - sub_bucket_bits);
+		return lower + (std::uint64_t{1} << (exponent - sub_bucket_bits)) - 1;
+	}
+
+	[[nodiscard]] auto count() const noexcept -> std::uint64_t {
+		return m_count;
+	}
+
+	[[nodiscard]] auto max() const noexcept -> std::chrono::nanoseconds {
+		return std::chrono::nanoseconds{m_max};
+	}
+
+	[[nodiscard]] auto mean() const noexcept -> std::chrono::nanoseconds {
+		return std::chrono::nanoseconds{m_count == 0 ? 0 : m_sum / m_count};
+	}
+
+	// Value below which the fraction of the recorded values lies, e.g. 0.99 for
+	// the 99th percentile. It is precise to the bucket it falls into.
+	[[nodiscard]] auto percentile(double fraction) const noexcept
+	    -> std::chrono::nanoseconds {
+		if (m_count == 0) {
+			return std::chrono::nanoseconds{0};
+		}
+		const auto rank = static_cast<std::uint64_t>(
+		    std::clamp(fraction, 0.0, 1.0) * static_cast<double>(m_count - 1));
+		std::uint64_t seen = 0;
+		for (std::size_t index = 0; index < bucket_count; ++index) {
+			seen += m_buckets[index];
+			if (seen > rank) {
+				return std::chrono::nanoseconds{
+				    std::min<std::uint64_t>(bucket_limit(index), m_max)};
+			}
+		}
+		return max();
+	}
+
+	// Recorded values of a bucket, see bucket_index()
+	[[nodiscard]] auto bucket(std::size_t index) const noexcept
+	    -> std::uint64_t {
+		return m_buckets[index];
+	}
+
+private:
+	friend class detail::histogram_recorder;
+
+	std::array<std::uint64_t, bucket_count> m_buckets{};
+	std::uint64_t                           m_count{0};
+	std::uint64_t                           m_sum{0};
+	std::uint64_t                           m_max{0};
+};
+
+// Snapshot of the metrics of a scheduler, see QThreadScheduler::metrics()
+// and the metrics() of the QThreadPool scheduler
+struct scheduler_metrics {
+	// Operations queued that did not start yet
+	std::int64_t pending{0};
+	// Highest number of pending operations so far
+	std::int64_t peakPending{0};
+	// From queueing an operation until its completion starts
+	duration_histogram delay;
+	// From the deadline of schedule_at and schedule_after until the completion
+	// starts
+	duration_histogram timerLateness;
+};
+
+} // namespace stdexecutils::qt
+
+#endif // STDEXEC_UTILS_METRICS_HPP
@@ -0,0 +1,302 @@
+#ifndef STDEXEC_UTILS_QFUTURE_HPP
+#define STDEXEC_UTILS_QFUTURE_HPP
+
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QPromise>
+
+#ifndef Q_MOC_RUN
+#include <stdexec/execution.hpp>
+#endif
+
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace stdexecutils::qt {
+namespace detail {
+
+template <class T>
+struct qfuture_value_signature {
+	using type = stdexec::set_value_t(T);
+};
+
+template <>
+struct qfuture_value_signature<void> {
+	using type = stdexec::set_value_t();
+};
+
+template <class T, class Recv>
+class qfuture_op_state {
+public:
+	qfuture_op_state(Recv&& receiver, QFuture<T> future) noexcept
+	    : m_receiver(std::move(receiver)), m_future(std::move(future)) {}
+
+	qfuture_op_state(const qfuture_op_state&) = delete;
+	qfuture_op_state(qfuture_op_state&&)      = delete;
+
+	void start() noexcept {
+		stdexec::stoppable_token auto stop_token =
+		    stdexec::get_stop_token(stdexec::get_env(m_receiver));
+		if (stop_token.stop_requested()) {
+			stdexec::set_stopped(std::move(m_receiver));
+			return;
+		}
+		if (stop_token.stop_possible()) {
+			m_stoppedCallback.emplace(std::move(stop_token),
+			                          stop_callback_fun{*this});
+		}
+		// The continuations run synchronously in the thread that finishes the
+		// future, or right here if it already finished. Exactly one of them runs:
+		// then() is skipped for a canceled future, which cancels the future it
+		// returns.
+		try {
+			m_future
+			    .then(QtFuture::Launch::Sync,
+			          [this](QFuture<T> future) { complete(std::move(future)); })
+			    .onCanceled([this]() { complete_stopped(); });
+		} catch (...) {
+			m_stoppedCallback.reset();
+			stdexec::set_error(std::move(m_receiver), std::current_exception());
+		}
+	}
+
+private:
+	struct stop_callback_fun {
+		qfuture_op_state& op_state;
+
+		void operator()() noexcept { op_state.m_future.cancel(); }
+	};
+
+	// Called for a finished future, or for one that failed with an exception
+	void complete(QFuture<T> future) noexcept {
+		// Waits for a concurrently running stop callback
+		m_stoppedCallback.reset();
+		try {
+			// Rethrows the exception of the future, it does not block
+			future.waitForFinished();
+			if constexpr (std::is_void_v<T>) {
+				stdexec::set_value(std::move(m_receiver));
+			} else if (future.resultCount() == 0) {
+				// E.g. a QPromise that finished without addResult
+				throw std::runtime_error("QFuture finished without a result");
+			} else if constexpr (std::is_copy_constructible_v<T>) {
+				stdexec::set_value(std::move(m_receiver), future.result());
+			} else {
+				stdexec::set_value(std::move(m_receiver), future.takeResult());
+			}
+		} catch (...) {
+			stdexec::set_error(std::move(m_receiver), std::current_exception());
+		}
+	}
+
+	void complete_stopped() noexcept {
+		m_stoppedCallback.reset();
+		stdexec::set_stopped(std::move(m_receiver));
+	}
+
+	using stop_callback = stdexec::stop_callback_for_t<
+	    stdexec::stop_token_of_t<stdexec::env_of_t<Recv>>, stop_callback_fun>;
+
+	Recv                         m_receiver;
+	QFuture<T>                   m_future;
+	std::optional<stop_callback> m_stoppedCallback;
+};
+
+template <class T>
+struct qfuture_sender {
+	using __id = qfuture_sender;
+	using __t  = qfuture_sender;
+
+	using sender_concept        = stdexec::sender_t;
+	using completion_signatures = stdexec::completion_signatures< //
+	    typename qfuture_value_signature<T>::type,                //
+	    stdexec::set_error_t(std::exception_ptr),                 //
+	    stdexec::set_stopped_t()>;
+
+	explicit qfuture_sender(QFuture<T> future) noexcept
+	    : m_future(std::move(future)) {}
+
+	// A QFuture has a single continuation, the sender can only be connected
+	// once
+	qfuture_sender(const qfuture_sender&) = delete;
+	qfuture_sender(qfuture_sender&&)      = default;
+
+	template <class R>
+	auto connect(R r) && -> qfuture_op_state<T, R> {
+		return qfuture_op_state<T, R>(std::move(r), std::move(m_future));
+	}
+
+	auto get_env() const noexcept -> stdexec::empty_env { return {}; }
+
+private:
+	QFuture<T> m_future;
+};
+
+// Environment of senders that are converted with as_qfuture, QFuture::cancel
+// requests stop
+struct qpromise_env {
+	auto query(stdexec::get_stop_token_t) const noexcept
+	    -> stdexec::inplace_stop_token {
+		return m_token;
+	}
+
+	stdexec::inplace_stop_token m_token;
+};
+
+template <class... Values>
+struct qfuture_result {
+	using type = std::tuple<Values...>;
+};
+
+template <>
+struct qfuture_result<> {
+	using type = void;
+};
+
+template <class Value>
+struct qfuture_result<Value> {
+	using type = Value;
+};
+
+// Result type of the QFuture of a sender: void without values, the value, or
+// a std::tuple of the values
+template <class... Values>
+using qfuture_result_t = typename qfuture_result<std::decay_t<Values>...>::type;
+
+// Senders that never complete with a value have a QFuture<void>
+template <class... Results>
+struct qfuture_single_result;
+
+template <>
+struct qfuture_single_result<> {
+	using type = void;
+};
+
+template <class Result>
+struct qfuture_single_result<Result> {
+	using type = Result;
+};
+
+template <class... Results>
+using qfuture_single_result_t = typename qfuture_single_result<Results...>::type;
+
+template <class Sender>
+using qfuture_result_of_t =
+    stdexec::value_types_of_t<Sender, qpromise_env, qfuture_result_t,
+                              qfuture_single_result_t>;
+
+// Operation state of as_qfuture, it backs the QPromise of the future. It
+// watches the future for QFuture::cancel and deletes itself on its thread
+// once the sender completed.
+template <class Sender, class T>
+class qpromise_op_state : public QFutureWatcher<T> {
+public:
+	explicit qpromise_op_state(Sender&& sender)
+	    : m_opState(stdexec::connect(std::forward<Sender>(sender),
+	                                 receiver{this})) {
+		QObject::connect(this, &QFutureWatcherBase::canceled, this,
+		                 [this]() { m_stopSource.request_stop(); });
+		this->setFuture(m_promise.future());
+	}
+
+	auto start() -> QFuture<T> {
+		auto future = m_promise.future();
+		m_promise.start();
+		stdexec::start(m_opState);
+		return future;
+	}
+
+private:
+	struct receiver {
+		using __id = receiver;
+		using __t  = receiver;
+
+		using receiver_concept = stdexec::receiver_t;
+
+		template <class... Values>
+		void set_value(Values&&... values) noexcept {
+			auto& promise = m_self->m_promise;
+			try {
+				if constexpr (!std::is_void_v<T>) {
+					promise.addResult(T(std::forward<Values>(values)...));
+				}
+			} catch (...) {
+				promise.setException(std::current_exception());
+			}
+			m_self->finish();
+		}
+
+		template <class Error>
+		void set_error(Error&& error) noexcept {
+			if constexpr (std::is_same_v<std::decay_t<Error>, std::exception_ptr>) {
+				m_self->m_promise.setException(std::forward<Error>(error));
+			} else {
+				m_self->m_promise.setException(
+				    std::make_exception_ptr(std::forward<Error>(error)));
+			}
+			m_self->finish();
+		}
+
+		void set_stopped() noexcept {
+			m_self->m_promise.future().cancel();
+			m_self->finish();
+		}
+
+		[[nodiscard]] auto get_env() const noexcept -> qpromise_env {
+			return {m_self->m_stopSource.get_token()};
+		}
+
+		qpromise_op_state* m_self;
+	};
+
+	void finish() noexcept {
+		m_promise.finish();
+		// Called from any thread, the watcher is deleted on its own
+		this->deleteLater();
+	}
+
+	QPromise<T>                                 m_promise;
+	stdexec::inplace_stop_source                m_stopSource;
+	stdexec::connect_result_t<Sender, receiver> m_opState;
+};
+} // namespace detail
+
+// Sender that completes with the result of a QFuture: the first result, or no
+// value for QFuture<void>. An exception of the future is passed on with
+// set_error, a canceled future completes with set_stopped, and a stop request
+// cancels the future.
+//
+// The sender completes on the thread that finishes the future, without
+// blocking and without a hop through an event loop. It takes over the
+// continuation of the future: Qt keeps one per future, so the future must
+// not have a then() of its own, and the sender is move-only and can be
+// connected once. A future that finished without a result completes with
+// set_error.
+template <class T>
+auto as_sender(QFuture<T> future) -> detail::qfuture_sender<T> {
+	return detail::qfuture_sender<T>(std::move(future));
+}
+
+// Starts a sender and returns a QFuture for its result, the sender's
+// operation state backs the QPromise of the future. QFuture::cancel requests
+// stop of the sender. Errors of the sender are set as exception of the
+// future, set_stopped cancels it.
+//
+// Cancellation is observed with a QFutureWatcher, so the calling thread
+// needs an event loop.
+template <stdexec::sender_in<detail::qpromise_env> Sender>
+auto as_qfuture(Sender&& sender)
+    -> QFuture<detail::qfuture_result_of_t<Sender>> {
+	using result_type = detail::qfuture_result_of_t<Sender>;
+	auto* const opState = new detail::qpromise_op_state<Sender, result_type>(
+	    std::forward<Sender>(sender));
+	return opState->start();
+}
+
+} // namespace stdexecutils::qt
+
+#endif // STDEXEC_UTILS_QFUTURE_HPP
@@ -0,0 +1,354 @@
+#ifndef STDEXEC_UTILS_QIODEVICE_HPP
+#define STDEXEC_UTILS_QIODEVICE_HPP
+
+#include <stdexecutils/qt/detail/object_operation.hpp>
+
+#include <QFileDevice>
+#include <QIODevice>
+#include <QObject>
+#include <QString>
+
+#ifndef Q_MOC_RUN
+#include <stdexec/execution.hpp>
+#endif
+
+#include <cstddef>
+#include <exception>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace stdexecutils::qt {
+
+// Error of an operation on a QIODevice, with the errorString() of the device
+class io_error : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+
+inline auto make_io_error(const QString& message) noexcept
+    -> std::exception_ptr {
+	try {
+		return std::make_exception_ptr(io_error(message.toStdString()));
+	} catch (...) {
+		return std::current_exception();
+	}
+}
+
+// Operation on a QIODevice, see object_operation.
+//
+// Derived makes progress in progress(), which returns true once the operation
+// is done, and passes its value on in complete(). Until then it is re-checked
+// whenever one of the signals that Derived watches in watch_signals() is
+// emitted. It fails by setting m_error, or by throwing from progress().
+template <class Derived, class Recv>
+class io_operation
+    : public object_operation<io_operation<Derived, Recv>, Recv, QIODevice, 3> {
+	using base = object_operation<io_operation, Recv, QIODevice, 3>;
+
+public:
+	using base::base;
+
+protected:
+	// Re-checks the progress when the signal is emitted, raised is set first
+	template <class Signal>
+	void watch(Signal signal, bool* raised = nullptr) {
+		this->connect_signal(signal, [this, raised]() {
+			if (raised != nullptr) {
+				*raised = true;
+			}
+			on_event();
+		});
+	}
+
+	[[nodiscard]] auto device() const noexcept -> QIODevice& {
+		return this->object();
+	}
+
+	// Set by aboutToClose, the device is still open while it is emitted
+	[[nodiscard]] auto closing() const noexcept -> bool { return m_closing; }
+
+	std::exception_ptr m_error;
+
+private:
+	friend base;
+
+	enum class outcome { pending, done, stopped };
+
+	auto on_connect() -> bool {
+		// Completes right away when the data is already there
+		if (check()) {
+			finish();
+			return false;
+		}
+		static_cast<Derived&>(*this).watch_signals();
+		watch(&QIODevice::aboutToClose, &m_closing);
+		return true;
+	}
+
+	void on_event() noexcept {
+		if (m_outcome == outcome::pending && check()) {
+			settle(outcome::done);
+		}
+	}
+
+	// Returns true once the operation is done
+	auto check() noexcept -> bool {
+		try {
+			return static_cast<Derived&>(*this).progress();
+		} catch (...) {
+			m_error = std::current_exception();
+			return true;
+		}
+	}
+
+	void on_destroyed() noexcept { settle(outcome::stopped); }
+
+	void on_cancel() noexcept {
+		if (m_outcome == outcome::pending) {
+			m_outcome = outcome::stopped;
+		}
+		deliver();
+	}
+
+	void settle(outcome result) noexcept {
+		m_outcome = result;
+		if (this->disconnect()) {
+			deliver();
+		}
+		// Otherwise the queued cancel task delivers the outcome
+	}
+
+	void deliver() noexcept {
+		if (m_outcome == outcome::done) {
+			finish();
+		} else {
+			stdexec::set_stopped(std::move(this->m_receiver));
+		}
+	}
+
+	void finish() noexcept {
+		if (m_error) {
+			stdexec::set_error(std::move(this->m_receiver), std::move(m_error));
+		} else {
+			static_cast<Derived&>(*this).complete();
+		}
+	}
+
+	outcome m_outcome{outcome::pending};
+	bool    m_closing{false};
+};
+
+// Operation state of async_read_some and, with Exact, of async_read_exact.
+// The data is read from the buffer of the device straight into the buffer of
+// the caller.
+template <class Recv, bool Exact>
+class read_op_state : public io_operation<read_op_state<Recv, Exact>, Recv> {
+	using base = io_operation<read_op_state, Recv>;
+
+public:
+	read_op_state(Recv&& receiver, QIODevice* device,
+	              std::span<std::byte> buffer)
+	    : base(std::move(receiver), device), m_buffer(buffer) {}
+
+private:
+	friend base;
+
+	void watch_signals() {
+		this->watch(&QIODevice::readyRead);
+		this->watch(&QIODevice::readChannelFinished, &m_channelFinished);
+	}
+
+	auto progress() -> bool {
+		auto& device = this->device();
+		while (m_transferred < m_buffer.size() && device.isOpen()) {
+			const auto count = device.read(
+			    reinterpret_cast<char*>(m_buffer.data() + m_transferred),
+			    static_cast<qint64>(m_buffer.size() - m_transferred));
+			if (count < 0) {
+				if (at_end()) {
+					break;
+				}
+				this->m_error = make_io_error(device.errorString());
+				return true;
+			}
+			if (count == 0) {
+				break;
+			}
+			m_transferred += static_cast<std::size_t>(count);
+			if constexpr (!Exact) {
+				return true;
+			}
+		}
+		if (m_transferred == m_buffer.size()) {
+			return true;
+		}
+		if (!at_end()) {
+			return false;
+		}
+		// async_read_some completes with 0 bytes at the end of the stream
+		if constexpr (Exact) {
+			this->m_error = make_io_error(
+			    QStringLiteral("End of stream after %1 of %2 bytes")
+			        .arg(m_transferred)
+			        .arg(m_buffer.size()));
+		}
+		return true;
+	}
+
+	[[nodiscard]] auto at_end() const noexcept -> bool {
+		const auto& device = this->device();
+		return m_channelFinished || this->closing() || !device.isOpen() ||
+		       (!device.isSequential() && device.atEnd());
+	}
+
+	void complete() noexcept {
+		stdexec::set_value(std::move(this->m_receiver), m_transferred);
+	}
+
+	const std::span<std::byte> m_buffer;
+	std::size_t                m_transferred{0};
+	bool                       m_channelFinished{false};
+};
+
+// Operation state of async_write. QIODevice::write copies into the write
+// buffer of the device, the operation completes once that is drained. Files
+// and other random-access devices emit no bytesWritten, a QFileDevice is
+// flushed instead and the operation completes right after the write.
+template <class Recv>
+class write_op_state : public io_operation<write_op_state<Recv>, Recv> {
+	using base = io_operation<write_op_state, Recv>;
+
+public:
+	write_op_state(Recv&& receiver, QIODevice* device,
+	               std::span<const std::byte> data)
+	    : base(std::move(receiver), device), m_data(data) {}
+
+private:
+	friend base;
+
+	void watch_signals() { this->watch(&QIODevice::bytesWritten); }
+
+	auto progress() -> bool {
+		auto& device = this->device();
+		if (!device.isOpen() || this->closing()) {
+			this->m_error = make_io_error(
+			    QStringLiteral("Device closed after %1 of %2 bytes")
+			        .arg(m_transferred)
+			        .arg(m_data.size()));
+			return true;
+		}
+		while (m_transferred < m_data.size()) {
+			const auto count = device.write(
+			    reinterpret_cast<const char*>(m_data.data() + m_transferred),
+			    static_cast<qint64>(m_data.size() - m_transferred));
+			if (count < 0) {
+				this->m_error = make_io_error(device.errorString());
+				return true;
+			}
+			if (count == 0) {
+				return false;
+			}
+			m_transferred += static_cast<std::size_t>(count);
+		}
+		if (!device.isSequential()) {
+			auto* const file = qobject_cast<QFileDevice*>(&device);
+			if (file != nullptr && !file->flush()) {
+				this->m_error = make_io_error(file->errorString());
+			}
+			return true;
+		}
+		return device.bytesToWrite() == 0;
+	}
+
+	void complete() noexcept {
+		stdexec::set_value(std::move(this->m_receiver), m_transferred);
+	}
+
+	const std::span<const std::byte> m_data;
+	std::size_t                      m_transferred{0};
+};
+
+using io_completion_signatures = stdexec::completion_signatures< //
+    stdexec::set_value_t(std::size_t),                           //
+    stdexec::set_error_t(std::exception_ptr),                    //
+    stdexec::set_stopped_t()>;
+
+template <bool Exact>
+struct read_sender {
+	using __id = read_sender;
+	using __t  = read_sender;
+
+	using sender_concept        = stdexec::sender_t;
+	using completion_signatures = io_completion_signatures;
+
+	read_sender(QIODevice* device, std::span<std::byte> buffer) noexcept
+	    : m_device(device), m_buffer(buffer) {}
+
+	template <class R>
+	auto connect(R r) const -> read_op_state<R, Exact> {
+		return read_op_state<R, Exact>(std::move(r), m_device, m_buffer);
+	}
+
+	auto get_env() const noexcept -> stdexec::empty_env { return {}; }
+
+private:
+	QIODevice*           m_device;
+	std::span<std::byte> m_buffer;
+};
+
+struct write_sender {
+	using __id = write_sender;
+	using __t  = write_sender;
+
+	using sender_concept        = stdexec::sender_t;
+	using completion_signatures = io_completion_signatures;
+
+	write_sender(QIODevice* device, std::span<const std::byte> data) noexcept
+	    : m_device(device), m_data(data) {}
+
+	template <class R>
+	auto connect(R r) const -> write_op_state<R> {
+		return write_op_state<R>(std::move(r), m_device, m_data);
+	}
+
+	auto get_env() const noexcept -> stdexec::empty_env { return {}; }
+
+private:
+	QIODevice*                 m_device;
+	std::span<const std::byte> m_data;
+};
+} // namespace detail
+
+// The senders below work on any QIODevice, like a QLocalSocket, a QProcess or
+// a QFile, that lives on a thread with an event loop. They complete on that
+// thread, directly from readyRead and bytesWritten, or right away for files
+// and other random-access devices. The buffers belong to the caller
+// and must outlive the operation. Errors of the device are passed on as
+// io_error, stop requests complete with set_stopped.
+
+// Reads the data that is available, at least one byte, into the buffer.
+// Completes with the number of bytes read, 0 at the end of the stream.
+inline auto async_read_some(QIODevice* device, std::span<std::byte> buffer)
+    -> detail::read_sender<false> {
+	return {device, buffer};
+}
+
+// Reads until the buffer is full, completes with the size of the buffer. The
+// end of the stream before that is an io_error.
+inline auto async_read_exact(QIODevice* device, std::span<std::byte> buffer)
+    -> detail::read_sender<true> {
+	return {device, buffer};
+}
+
+// Writes all of the data, completes with its size once the device wrote it
+inline auto async_write(QIODevice* device, std::span<const std::byte> data)
+    -> detail::write_sender {
+	return {device, data};
+}
+
+} // namespace stdexecutils::qt
+
+#endif // STDEXEC_UTILS_QIODEVICE_HPP
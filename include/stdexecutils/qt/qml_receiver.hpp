@@ -6,59 +6,30 @@
 #include <stdexec/execution.hpp>
 #endif
 
+#include <stdexecutils/qt/detail/size_class_pool.hpp>
 #include <stdexecutils/qt/qthread_scheduler.hpp>
+#include <stdexecutils/qt/script_value.hpp>
 
 #include <QObject>
 #include <QJSEngine>
 
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
 namespace stdexecutils::qt {
 namespace detail {
 
-namespace {
-
-template <class T>
-auto customToScriptValue(QJSEngine* const jsEngine, const T& v) -> QJSValue {
-	return jsEngine->toScriptValue(v);
-}
-template <>
-auto customToScriptValue<std::string>(QJSEngine* const   jsEngine,
-                                      const std::string& stdString)
-    -> QJSValue {
-	return jsEngine->toScriptValue(QString::fromStdString(stdString));
-}
-template <>
-auto customToScriptValue<std::string_view>(QJSEngine* const        jsEngine,
-                                           const std::string_view& stdString)
-    -> QJSValue {
-	return jsEngine->toScriptValue(QString(stdString.data()));
-}
-template <>
-auto customToScriptValue<const char*>(QJSEngine* const   jsEngine,
-                                      const char* const& cString) -> QJSValue {
-	return jsEngine->toScriptValue(QString(cString));
-}
-template <>
-auto customToScriptValue<std::exception_ptr>(
-    QJSEngine* const jsEngine, const std::exception_ptr& exception)
-    -> QJSValue {
-	try {
-		std::rethrow_exception(exception);
-	} catch (std::exception& e) {
-		return customToScriptValue(jsEngine, e.what());
-	} catch (...) {
+// Allocator for the operation state of a QmlReceiver: the one of the
+// environment if it has one, the per-thread pool otherwise
+template <class Env>
+auto op_state_allocator(const Env& env) noexcept {
+	if constexpr (stdexec::__callable<stdexec::get_allocator_t, const Env&>) {
+		return stdexec::get_allocator(env);
+	} else {
+		return pool_allocator<std::byte>{};
 	}
-	return QJSValue::UndefinedValue;
-}
-// Add more specializations that convert C++ types into
-template <class... Args>
-auto toValueList(QJSEngine* const jsEngine, Args&&... args) -> QJSValueList {
-	QJSValueList list;
-	([&](auto&& v) { list.append(customToScriptValue(jsEngine, v)); }(
-	     std::forward<Args>(args)),
-	 ...);
-	return list;
 }
-} // namespace
 } // namespace detail
 
 class QmlReceiver : public QObject {
@@ -86,16 +57,22 @@ public:
 	template <stdexec::queryable Env>
 	struct op_state_base {
 
-		using _Env = Env;
+		using _Env       = Env;
+		using destroy_fn = void (*)(op_state_base*) noexcept;
 
-		explicit op_state_base(Env&& env) noexcept : m_env(std::move(env)) {}
+		op_state_base(Env&& env, destroy_fn destroy) noexcept
+		    : m_env(std::move(env)), m_destroy(destroy) {}
 
 		op_state_base(const op_state_base&) = delete;
 		op_state_base(op_state_base&&)      = delete;
 
-		virtual ~op_state_base() = default;
+		// Destroys the operation state and returns its memory to the allocator
+		void destroy() noexcept { m_destroy(this); }
 
 		Env m_env;
+
+	private:
+		destroy_fn m_destroy;
 	};
 	template <stdexec::queryable Env>
 	struct receiver : public stdexec::receiver_adaptor<receiver<Env>> {
@@ -107,22 +84,45 @@ public:
 
 		template <class... Args>
 		void set_value(Args&&... args) noexcept {
+			if (m_recieverObj.completes_inline()) {
+				auto* const receiverObj = &m_recieverObj;
+				// The values may live in the operation state, convert them first
+				auto values = detail::toValueList(qjsEngine(receiverObj),
+				                                  std::forward<Args>(args)...);
+				m_opState->destroy();
+				if (receiverObj->m_onValue.isCallable()) {
+					receiverObj->m_onValue.call(values);
+				}
+				return;
+			}
 			QMetaObject::invokeMethod(
 			    &m_recieverObj,
 			    [... args = std::forward<Args>(args),
-			     receiverObj = &m_recieverObj]() {
+			     receiverObj = &m_recieverObj]() mutable {
 				    if (receiverObj->m_onValue.isCallable()) {
-					    receiverObj->m_onValue.call(
-					        detail::toValueList(qjsEngine(receiverObj), args...));
+					    // The values are moved on, e.g. into an ArrayBuffer
+					    receiverObj->m_onValue.call(detail::toValueList(
+					        qjsEngine(receiverObj), std::move(args)...));
 				    }
 			    },
 			    Qt::QueuedConnection);
-			delete m_opState;
-			m_opState = nullptr;
+			// Destroys this receiver as well
+			m_opState->destroy();
 		}
 
 		template <class... Args>
 		void set_error(Args&&... args) noexcept {
+			if (m_recieverObj.completes_inline()) {
+				auto* const receiverObj = &m_recieverObj;
+				// The errors may live in the operation state, convert them first
+				auto values = detail::toValueList(qjsEngine(receiverObj),
+				                                  std::forward<Args>(args)...);
+				m_opState->destroy();
+				if (receiverObj->m_onError.isCallable()) {
+					receiverObj->m_onError.call(values);
+				}
+				return;
+			}
 			QMetaObject::invokeMethod(
 			    &m_recieverObj,
 			    [... args    = std::forward<Args>(args),
@@ -133,11 +133,19 @@ public:
 				    }
 			    },
 			    Qt::QueuedConnection);
-			delete m_opState;
-			m_opState = nullptr;
+			// Destroys this receiver as well
+			m_opState->destroy();
 		}
 
 		void set_stopped() noexcept {
+			if (m_recieverObj.completes_inline()) {
+				auto* const receiverObj = &m_recieverObj;
+				m_opState->destroy();
+				if (receiverObj->m_onStopped.isCallable()) {
+					receiverObj->m_onStopped.call();
+				}
+				return;
+			}
 			QMetaObject::invokeMethod(
 			    &m_recieverObj,
 			    [receiverObj = &m_recieverObj]() {
@@ -146,8 +154,8 @@ public:
 				    }
 			    },
 			    Qt::QueuedConnection);
-			delete m_opState;
-			m_opState = nullptr;
+			// Destroys this receiver as well
+			m_opState->destroy();
 		}
 
 		[[nodiscard]] auto get_env() const noexcept -> const Env& {
@@ -159,34 +167,77 @@ public:
 		QmlReceiver&        m_recieverObj;
 	};
 
-	template <stdexec::sender Sender, stdexec::queryable Env>
+	template <stdexec::sender Sender, stdexec::queryable Env, class Allocator>
 	struct op_state : public op_state_base<Env> {
+		using allocator_type = typename std::allocator_traits<
+		    Allocator>::template rebind_alloc<op_state>;
 
-		op_state(Sender&& sender, Env&& env, QmlReceiver& receiverObj) noexcept
-		    : m_connectOpState(stdexec::connect(std::move(sender),
+		op_state(Sender&& sender, Env&& env, QmlReceiver& receiverObj,
+		         const allocator_type& allocator)
+		    : op_state_base<Env>(std::forward<Env>(env), &op_state::destroy),
+		      m_connectOpState(stdexec::connect(std::move(sender),
 		                                        receiver<Env>(receiverObj, this))),
-		      op_state_base<Env>(std::forward<Env>(env)) {}
+		      m_allocator(allocator) {}
+
+		// Allocates the operation state with the given allocator, it frees itself
+		// after the completion
+		static auto create(Sender&& sender, Env&& env, QmlReceiver& receiverObj,
+		                   const Allocator& allocator) -> op_state* {
+			using traits = std::allocator_traits<allocator_type>;
+			allocator_type opStateAllocator(allocator);
+			auto* const    opState = traits::allocate(opStateAllocator, 1);
+			try {
+				traits::construct(opStateAllocator, opState, std::move(sender),
+				                  std::forward<Env>(env), receiverObj,
+				                  opStateAllocator);
+			} catch (...) {
+				// connect may throw
+				traits::deallocate(opStateAllocator, opState, 1);
+				throw;
+			}
+			return opState;
+		}
 
 		void start() noexcept { stdexec::start(m_connectOpState); }
 
 	private:
+		static void destroy(op_state_base<Env>* base) noexcept {
+			using traits = std::allocator_traits<allocator_type>;
+			auto* const    self = static_cast<op_state*>(base);
+			allocator_type allocator(std::move(self->m_allocator));
+			traits::destroy(allocator, self);
+			traits::deallocate(allocator, self, 1);
+		}
+
 		stdexec::connect_result_t<Sender, stdexec::__t<receiver<Env>>>
 		    m_connectOpState;
+		[[no_unique_address]] allocator_type m_allocator;
 	};
 
 public:
+	// Selects the immediate completion mode
+	struct immediate_completion_t {
+		explicit immediate_completion_t() = default;
+	};
+	static constexpr immediate_completion_t immediate_completion{};
+
+	// The operation state is allocated with the allocator that get_allocator
+	// returns for env, or from a per-thread pool if env has none
 	template <stdexec::sender Sender, stdexec::queryable Env = stdexec::empty_env>
 	QmlReceiver(Sender&& sender, Env&& env = stdexec::empty_env{},
 	            QObject* parent = nullptr)
 	    : QObject(parent) {
-		// Note this is not a memory leak: op_state is cleaned up when the executor
-		// terminates
-		static_assert(stdexec::receiver<receiver<Env>>, "not a valid receiver");
-		stdexec::start(*(new op_state<Sender, stdexec::env<receiver_env, Env>>(
-		    std::move(sender),
-		    stdexec::env<receiver_env, Env>(receiver_env(*this),
-		                                    std::forward<Env>(env)),
-		    *this)));
+		start(std::forward<Sender>(sender), std::forward<Env>(env));
+	}
+
+	// Completions on the thread of the receiver call the JS handlers inline,
+	// instead of through a queued call, once then() attached them. Completions
+	// on other threads, or before then(), are still queued.
+	template <stdexec::sender Sender, stdexec::queryable Env = stdexec::empty_env>
+	QmlReceiver(immediate_completion_t /*mode*/, Sender&& sender,
+	            Env&& env = stdexec::empty_env{}, QObject* parent = nullptr)
+	    : QObject(parent), m_immediate(true) {
+		start(std::forward<Sender>(sender), std::forward<Env>(env));
 	}
 
 	static void registerMetatype(const char* moduleUri          = "QmlReceiver",
@@ -205,12 +256,37 @@ private:
 	template <stdexec::queryable Env>
 	friend struct receiver;
 
+	template <class Sender, class Env>
+	void start(Sender&& sender, Env&& env) {
+		// Note this is not a memory leak: op_state is cleaned up when the executor
+		// terminates
+		static_assert(stdexec::receiver<receiver<Env>>, "not a valid receiver");
+		const auto allocator = detail::op_state_allocator(env);
+		using op_state_t = op_state<Sender, stdexec::env<receiver_env, Env>,
+		                            std::remove_const_t<decltype(allocator)>>;
+		stdexec::start(*op_state_t::create(
+		    std::move(sender),
+		    stdexec::env<receiver_env, Env>(receiver_env(*this),
+		                                    std::forward<Env>(env)),
+		    *this, allocator));
+	}
+
+	// m_handlersAttached is written by then() on the thread of the receiver, it
+	// is only read on that thread
+	[[nodiscard]] auto completes_inline() const noexcept -> bool {
+		return m_immediate && QThread::currentThread() == thread() &&
+		       m_handlersAttached;
+	}
+
 	friend struct receiver_env;
 
 	QJSValue m_onValue   = QJSValue::UndefinedValue;
 	QJSValue m_onError   = QJSValue::UndefinedValue;
 	QJSValue m_onStopped = QJSValue::UndefinedValue;
 
+	const bool m_immediate{false};
+	bool       m_handlersAttached{false};
+
 	stdexec::inplace_stop_source m_stopSource;
 };
 
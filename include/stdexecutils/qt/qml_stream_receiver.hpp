@@ -0,0 +1,509 @@
+#ifndef STDEXEC_UTILS_QML_STREAM_RECEIVER_HPP
+#define STDEXEC_UTILS_QML_STREAM_RECEIVER_HPP
+
+#ifndef Q_MOC_RUN
+#include <exec/env.hpp>
+#include <exec/sequence_senders.hpp>
+#include <stdexec/execution.hpp>
+#endif
+
+#include <stdexecutils/qt/detail/size_class_pool.hpp>
+#include <stdexecutils/qt/qml_receiver.hpp>
+#include <stdexecutils/qt/qthread_scheduler.hpp>
+
+#include <QBasicTimer>
+#include <QJSEngine>
+#include <QObject>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace stdexecutils::qt {
+class QmlStreamReceiver;
+
+namespace detail {
+
+// Values of a stream item, kept until they are delivered on the thread of the
+// receiver. Items are allocated from the per-thread pool.
+struct stream_item {
+	using convert_fn = auto (*)(stream_item*, QJSEngine*) -> QJSValueList;
+	using destroy_fn = void (*)(stream_item*) noexcept;
+
+	stream_item(convert_fn convert, destroy_fn destroy) noexcept
+	    : m_convert(convert), m_destroy(destroy) {}
+
+	stream_item(const stream_item&) = delete;
+	stream_item(stream_item&&)      = delete;
+
+	stream_item* m_next{nullptr};
+	convert_fn   m_convert;
+	destroy_fn   m_destroy;
+};
+
+struct stream_item_deleter {
+	void operator()(stream_item* item) const noexcept { item->m_destroy(item); }
+};
+
+using stream_item_ptr = std::unique_ptr<stream_item, stream_item_deleter>;
+
+template <class... Values>
+struct stream_item_of : public stream_item {
+	template <class... Args>
+	explicit stream_item_of(Args&&... args)
+	    : stream_item(&stream_item_of::convert, &stream_item_of::destroy),
+	      m_values(std::forward<Args>(args)...) {}
+
+	template <class... Args>
+	static auto create(Args&&... args) -> stream_item_ptr {
+		pool_allocator<stream_item_of> allocator;
+		auto* const                    item = allocator.allocate(1);
+		try {
+			return stream_item_ptr(
+			    new (item) stream_item_of(std::forward<Args>(args)...));
+		} catch (...) {
+			allocator.deallocate(item, 1);
+			throw;
+		}
+	}
+
+private:
+	// Moves the values into JS values, the item is consumed
+	static auto convert(stream_item* item, QJSEngine* jsEngine)
+	    -> QJSValueList {
+		auto& self = *static_cast<stream_item_of*>(item);
+		return std::apply(
+		    [jsEngine](auto&... values) {
+			    return toValueList(jsEngine, std::move(values)...);
+		    },
+		    self.m_values);
+	}
+
+	static void destroy(stream_item* item) noexcept {
+		auto* const self = static_cast<stream_item_of*>(item);
+		std::destroy_at(self);
+		pool_allocator<stream_item_of>{}.deallocate(self, 1);
+	}
+
+	std::tuple<Values...> m_values;
+};
+
+// Producer of an item, it waits while the queue of the receiver is full
+struct stream_waiter {
+	using resume_fn = void (*)(stream_waiter*, bool stopped) noexcept;
+
+	explicit stream_waiter(resume_fn resume) noexcept : m_resume(resume) {}
+
+	stream_waiter* m_next{nullptr};
+	resume_fn      m_resume;
+	stream_item*   m_item{nullptr};
+};
+
+// Link between a QmlStreamReceiver and the operation state of its sequence,
+// the operation state derives from it. Both hold a reference: the receiver
+// detaches when it is destroyed, so a sequence that still runs no longer
+// reaches it, and whoever lets go last frees the operation state. The stop
+// source lives here as well, the sequence keeps using it after the receiver
+// is gone.
+class stream_link {
+public:
+	using destroy_fn = void (*)(stream_link*) noexcept;
+
+	stream_link(QmlStreamReceiver* streamObj, destroy_fn destroy) noexcept
+	    : m_streamObj(streamObj), m_destroy(destroy) {}
+
+	stream_link(const stream_link&) = delete;
+	stream_link(stream_link&&)      = delete;
+
+	// Calls fun with the receiver unless it detached, it is not destroyed
+	// meanwhile. fun must not resume producers, they may push again.
+	template <class Fun>
+	auto with_receiver(Fun&& fun) -> bool {
+		const std::lock_guard lock(m_mutex);
+		if (m_streamObj == nullptr) {
+			return false;
+		}
+		std::forward<Fun>(fun)(*m_streamObj);
+		return true;
+	}
+
+	// Called by the receiver on destruction, waits for a running with_receiver
+	void detach() noexcept {
+		{
+			const std::lock_guard lock(m_mutex);
+			m_streamObj = nullptr;
+		}
+		release();
+	}
+
+	// Called by the receiver of the sequence after it completed
+	void release() noexcept {
+		if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			m_destroy(this);
+		}
+	}
+
+	void request_stop() noexcept { m_stopSource.request_stop(); }
+
+	[[nodiscard]] auto stop_requested() const noexcept -> bool {
+		return m_stopSource.stop_requested();
+	}
+
+	[[nodiscard]] auto get_stop_token() const noexcept
+	    -> stdexec::inplace_stop_token {
+		return m_stopSource.get_token();
+	}
+
+private:
+	std::mutex                   m_mutex;
+	QmlStreamReceiver*           m_streamObj;
+	std::atomic<int>             m_refs{2};
+	const destroy_fn             m_destroy;
+	stdexec::inplace_stop_source m_stopSource;
+};
+} // namespace detail
+
+// Receiver for sequence senders that hands every item to a JS callback.
+//
+// Items are queued on the producing thread and delivered on the thread of the
+// receiver. The policy decides how items that arrive faster than the event
+// loop can present them are coalesced: only the latest, all of them in one
+// array, or at most a fixed number per delivery. Deliveries are at least
+// `interval` apart, the default is about one per frame. While `capacity` items
+// are queued the producer waits for the next delivery, except with LatestOnly,
+// which replaces the queued item instead.
+class QmlStreamReceiver : public QObject {
+	Q_OBJECT
+public:
+	enum class Coalescing { LatestOnly, Batch, MaxPerTick };
+	Q_ENUM(Coalescing)
+
+	struct Policy {
+		Coalescing                mode{Coalescing::LatestOnly};
+		std::size_t               maxPerTick{1};  // For MaxPerTick
+		std::size_t               capacity{1024}; // At least 1, not for LatestOnly
+		std::chrono::milliseconds interval{16};
+	};
+
+	// Does not refer to the receiver object, the sequence may outlive it
+	struct receiver_env {
+		receiver_env(const detail::stream_link* link, QThread* thread) noexcept
+		    : m_link(link), m_thread(thread) {}
+
+		auto query(stdexec::get_scheduler_t) const noexcept -> QThreadScheduler {
+			return QThreadScheduler{m_thread};
+		}
+
+		auto query(stdexec::get_delegatee_scheduler_t) const noexcept
+		    -> QThreadScheduler {
+			return QThreadScheduler{m_thread};
+		}
+
+		auto query(stdexec::get_stop_token_t) const noexcept {
+			return m_link->get_stop_token();
+		}
+
+	private:
+		const detail::stream_link* m_link;
+		QThread*                   m_thread;
+	};
+
+	// Sender returned by set_next, it completes once the item is queued
+	struct push_sender {
+		using __id = push_sender;
+		using __t  = push_sender;
+
+		using sender_concept        = stdexec::sender_t;
+		using completion_signatures = stdexec::completion_signatures< //
+		    stdexec::set_value_t(),                                   //
+		    stdexec::set_stopped_t()>;
+
+		template <class Recv>
+		struct op_state : public detail::stream_waiter {
+			op_state(Recv&& receiver, detail::stream_link* link,
+			         detail::stream_item_ptr item) noexcept
+			    : detail::stream_waiter(&op_state::resume),
+			      m_receiver(std::move(receiver)), m_link(link),
+			      m_ownedItem(std::move(item)) {}
+
+			op_state(const op_state&) = delete;
+			op_state(op_state&&)      = delete;
+
+			void start() noexcept {
+				m_item      = m_ownedItem.release();
+				auto result = push_result::stopped;
+				if (!m_link->with_receiver([&](QmlStreamReceiver& streamObj) {
+					    result = streamObj.push(this);
+				    })) {
+					// The receiver is gone, the item is dropped
+					m_item->m_destroy(m_item);
+				}
+				// A parked producer may already be resumed, this is not touched
+				// anymore then
+				switch (result) {
+				case push_result::queued:
+					stdexec::set_value(std::move(m_receiver));
+					break;
+				case push_result::stopped:
+					stdexec::set_stopped(std::move(m_receiver));
+					break;
+				case push_result::parked:
+					break;
+				}
+			}
+
+		private:
+			static void resume(detail::stream_waiter* waiter,
+			                   bool                   stopped) noexcept {
+				auto& self = *static_cast<op_state*>(waiter);
+				if (stopped) {
+					stdexec::set_stopped(std::move(self.m_receiver));
+					return;
+				}
+				stdexec::set_value(std::move(self.m_receiver));
+			}
+
+			Recv                       m_receiver;
+			detail::stream_link* const m_link;
+			detail::stream_item_ptr    m_ownedItem;
+		};
+
+		push_sender(detail::stream_link* link, detail::stream_item_ptr item) noexcept
+		    : m_link(link), m_item(std::move(item)) {}
+
+		template <class R>
+		auto connect(R r) && -> op_state<R> {
+			return op_state<R>(std::move(r), m_link, std::move(m_item));
+		}
+
+		auto get_env() const noexcept -> stdexec::empty_env { return {}; }
+
+	private:
+		detail::stream_link*    m_link;
+		detail::stream_item_ptr m_item;
+	};
+
+	template <class Env>
+	struct op_state_base : public detail::stream_link {
+		using env_type = stdexec::env<receiver_env, Env>;
+
+		op_state_base(Env&& env, QmlStreamReceiver& streamObj,
+		              destroy_fn destroy) noexcept
+		    : detail::stream_link(&streamObj, destroy),
+		      m_env(receiver_env(this, streamObj.thread()), std::forward<Env>(env)) {
+		}
+
+		env_type m_env;
+	};
+
+	template <class Env>
+	struct receiver {
+		using __id = receiver<Env>;
+		using __t  = receiver<Env>;
+
+		using receiver_concept = stdexec::receiver_t;
+
+		explicit receiver(op_state_base<Env>* opState) noexcept
+		    : m_opState(opState) {}
+
+		template <stdexec::sender Item>
+		friend auto tag_invoke(exec::set_next_t, receiver& self,
+		                       Item&& item) noexcept {
+			return stdexec::let_value(
+			    std::forward<Item>(item),
+			    [link = static_cast<detail::stream_link*>(self.m_opState)](
+			        auto&... values) {
+				    return push_sender(
+				        link,
+				        detail::stream_item_of<std::decay_t<decltype(values)>...>::
+				            create(std::move(values)...));
+			    });
+		}
+
+		void set_value() noexcept {
+			m_opState->with_receiver([](QmlStreamReceiver& streamObj) {
+				streamObj.finish(completion::done, nullptr);
+			});
+			// Destroys this receiver as well, unless the receiver object still
+			// holds the operation state
+			m_opState->release();
+		}
+
+		template <class Error>
+		void set_error(Error&& error) noexcept {
+			detail::stream_item_ptr item;
+			try {
+				item = detail::stream_item_of<std::decay_t<Error>>::create(
+				    std::forward<Error>(error));
+			} catch (...) {
+			}
+			m_opState->with_receiver([&item](QmlStreamReceiver& streamObj) {
+				streamObj.finish(completion::failed, item.release());
+			});
+			m_opState->release();
+		}
+
+		void set_stopped() noexcept {
+			m_opState->with_receiver([](QmlStreamReceiver& streamObj) {
+				streamObj.finish(completion::stopped, nullptr);
+			});
+			m_opState->release();
+		}
+
+		[[nodiscard]] auto get_env() const noexcept ->
+		    typename op_state_base<Env>::env_type const& {
+			return m_opState->m_env;
+		}
+
+	private:
+		op_state_base<Env>* m_opState;
+	};
+
+	template <class Sender, class Env, class Allocator>
+	struct op_state : public op_state_base<Env> {
+		using allocator_type = typename std::allocator_traits<
+		    Allocator>::template rebind_alloc<op_state>;
+
+		op_state(Sender&& sender, Env&& env, QmlStreamReceiver& streamObj,
+		         const allocator_type& allocator)
+		    : op_state_base<Env>(std::forward<Env>(env), streamObj,
+		                         &op_state::destroy),
+		      m_subscribeOpState(
+		          exec::subscribe(std::move(sender), receiver<Env>(this))),
+		      m_allocator(allocator) {}
+
+		// Allocates the operation state with the given allocator, it frees itself
+		// once the sequence completed and the receiver object is destroyed
+		static auto create(Sender&& sender, Env&& env, QmlStreamReceiver& streamObj,
+		                   const Allocator& allocator) -> op_state* {
+			using traits = std::allocator_traits<allocator_type>;
+			allocator_type opStateAllocator(allocator);
+			auto* const    opState = traits::allocate(opStateAllocator, 1);
+			try {
+				traits::construct(opStateAllocator, opState, std::move(sender),
+				                  std::forward<Env>(env), streamObj,
+				                  opStateAllocator);
+			} catch (...) {
+				traits::deallocate(opStateAllocator, opState, 1);
+				throw;
+			}
+			return opState;
+		}
+
+		void start() noexcept { stdexec::start(m_subscribeOpState); }
+
+	private:
+		static void destroy(detail::stream_link* link) noexcept {
+			using traits = std::allocator_traits<allocator_type>;
+			auto* const    self = static_cast<op_state*>(link);
+			allocator_type allocator(std::move(self->m_allocator));
+			traits::destroy(allocator, self);
+			traits::deallocate(allocator, self, 1);
+		}
+
+		exec::subscribe_result_t<Sender, receiver<Env>> m_subscribeOpState;
+		[[no_unique_address]] allocator_type           m_allocator;
+	};
+
+	// The operation state is allocated with the allocator that get_allocator
+	// returns for env, or from a per-thread pool if env has none
+	template <exec::sequence_sender Sender,
+	          stdexec::queryable    Env = stdexec::empty_env>
+	QmlStreamReceiver(Sender&& sender, Policy policy = {},
+	                  Env&& env = stdexec::empty_env{}, QObject* parent = nullptr)
+	    : QObject(parent), m_policy(clamped(policy)) {
+		const auto allocator = detail::op_state_allocator(env);
+		using op_state_t =
+		    op_state<Sender, Env, std::remove_const_t<decltype(allocator)>>;
+		auto* const opState = op_state_t::create(
+		    std::move(sender), std::forward<Env>(env), *this, allocator);
+		m_link = opState;
+		opState->start();
+	}
+
+	// Requests stop of the sequence and resumes parked producers as stopped.
+	// It does not wait for the sequence, which no longer reaches the object.
+	~QmlStreamReceiver() override;
+
+	static void registerMetatype(const char* moduleUri = "QmlStreamReceiver",
+	                             int         moduleVersionMajor = 1,
+	                             int         moduleVersionMinor = 0);
+
+	// nextFunction is called for every delivered item, with Batch it gets an
+	// array of items instead. One of the others is called after the last item.
+	Q_INVOKABLE void subscribe(QJSValue nextFunction, QJSValue doneFunction = {},
+	                           QJSValue failedFunction  = {},
+	                           QJSValue stoppedFunction = {});
+
+public slots:
+	void requestStop() noexcept;
+
+protected:
+	void timerEvent(QTimerEvent* event) override;
+
+private:
+	enum class completion { none, done, failed, stopped };
+	enum class push_result { queued, parked, stopped };
+
+	// Without room for one item every push would wait for a delivery that
+	// never comes
+	static auto clamped(Policy policy) noexcept -> Policy {
+		policy.capacity = std::max<std::size_t>(policy.capacity, 1);
+		return policy;
+	}
+
+	// Queues the item of a producer, or parks the producer while the queue is
+	// full. Called from any thread. The producer is not resumed here unless it
+	// got parked, the caller completes it.
+	auto push(detail::stream_waiter* waiter) noexcept -> push_result;
+
+	// Called from any thread when the sequence completed, error holds the value
+	// of set_error
+	void finish(completion result, detail::stream_item* error) noexcept;
+
+	void schedule_delivery() noexcept;
+	void deliver();
+	void call_next(QJSEngine* jsEngine, detail::stream_item* item);
+
+	// Intrusive FIFO of queued items
+	struct item_queue {
+		void push_back(detail::stream_item* item) noexcept;
+		auto pop_front() noexcept -> detail::stream_item*;
+
+		detail::stream_item* m_head{nullptr};
+		detail::stream_item* m_tail{nullptr};
+		std::size_t          m_size{0};
+	};
+
+	const Policy m_policy;
+
+	std::mutex             m_mutex;
+	item_queue             m_items;
+	detail::stream_waiter* m_waitersHead{nullptr};
+	detail::stream_waiter* m_waitersTail{nullptr};
+	completion             m_completion{completion::none};
+	detail::stream_item*   m_error{nullptr};
+	bool                   m_deliveryScheduled{false};
+
+	QBasicTimer                           m_intervalTimer;
+	std::chrono::steady_clock::time_point m_lastDelivery;
+	bool                                  m_finished{false};
+
+	QJSValue m_onNext    = QJSValue::UndefinedValue;
+	QJSValue m_onDone    = QJSValue::UndefinedValue;
+	QJSValue m_onError   = QJSValue::UndefinedValue;
+	QJSValue m_onStopped = QJSValue::UndefinedValue;
+
+	detail::stream_link* m_link{nullptr};
+};
+
+} // namespace stdexecutils::qt
+
+#endif // STDEXEC_UTILS_QML_STREAM_RECEIVER_HPP
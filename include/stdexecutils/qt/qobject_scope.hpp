@@ -0,0 +1,314 @@
+#ifndef STDEXEC_UTILS_QOBJECT_SCOPE_HPP
+#define STDEXEC_UTILS_QOBJECT_SCOPE_HPP
+
+#include <stdexecutils/qt/detail/size_class_pool.hpp>
+
+#include <QObject>
+
+#ifndef Q_MOC_RUN
+#include <stdexec/execution.hpp>
+#endif
+
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace stdexecutils::qt {
+namespace detail {
+
+// Memory of the operations spawned in a QObjectScope. Blocks are bumped off
+// chunks in the size classes of size_class_pool, freed blocks are reused by
+// later spawns of the same class. Once no operation is left, the chunks are
+// rewound and serve the next spawns, so a scope stops allocating once it saw
+// its peak. Larger or over-aligned blocks go to operator new.
+//
+// Not synchronized, qobject_scope_state locks around it.
+class scope_arena {
+public:
+	static constexpr std::size_t chunk_size = 16 * 1024;
+
+	auto allocate(std::size_t size, std::size_t alignment) -> void* {
+		if (!fits(size, alignment)) {
+			return ::operator new(size, std::align_val_t{alignment});
+		}
+		const auto index = size_class_pool::class_index(size);
+		if (auto* const head = m_free[index]; head != nullptr) {
+			m_free[index] = head->next;
+			return head;
+		}
+		const auto blockSize = size_class_pool::class_size(index);
+		if (m_chunk == m_chunks.size() || m_offset + blockSize > chunk_size) {
+			next_chunk();
+		}
+		auto* const pointer = m_chunks[m_chunk].get() + m_offset;
+		m_offset += blockSize;
+		return pointer;
+	}
+
+	void deallocate(void* pointer, std::size_t size,
+	                std::size_t alignment) noexcept {
+		if (!fits(size, alignment)) {
+			::operator delete(pointer, std::align_val_t{alignment});
+			return;
+		}
+		const auto index = size_class_pool::class_index(size);
+		m_free[index]    = new (pointer) block{m_free[index]};
+	}
+
+	// Called once every block is freed
+	void reset() noexcept {
+		m_free.fill(nullptr);
+		m_chunk  = 0;
+		m_offset = 0;
+	}
+
+private:
+	struct block {
+		block* next;
+	};
+
+	static constexpr auto fits(std::size_t size, std::size_t alignment) noexcept
+	    -> bool {
+		return size <= size_class_pool::max_size &&
+		       alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+	}
+
+	void next_chunk() {
+		if (m_chunk < m_chunks.size()) {
+			++m_chunk;
+		}
+		if (m_chunk == m_chunks.size()) {
+			m_chunks.push_back(std::make_unique<std::byte[]>(chunk_size));
+		}
+		m_offset = 0;
+	}
+
+	std::vector<std::unique_ptr<std::byte[]>>    m_chunks;
+	std::size_t                                  m_chunk{0};
+	std::size_t                                  m_offset{0};
+	std::array<block*, size_class_pool::classes> m_free{};
+};
+
+// Environment of the work spawned in a QObjectScope
+struct qobject_scope_env {
+	auto query(stdexec::get_stop_token_t) const noexcept
+	    -> stdexec::inplace_stop_token {
+		return m_token;
+	}
+
+	stdexec::inplace_stop_token m_token;
+};
+
+class qobject_scope_state;
+
+// Part of the spawned operation states that the receiver completes
+struct scope_op_base {
+	using complete_fn = void (*)(scope_op_base*) noexcept;
+
+	qobject_scope_state* const m_scope;
+	const complete_fn          m_complete;
+};
+
+struct scope_receiver {
+	using __id = scope_receiver;
+	using __t  = scope_receiver;
+
+	using receiver_concept = stdexec::receiver_t;
+
+	// Values are dropped, like exec::async_scope::spawn
+	template <class... Values>
+	void set_value(Values&&... /*values*/) noexcept {
+		m_opState->m_complete(m_opState);
+	}
+
+	// Fire-and-forget work must handle its errors
+	template <class Error>
+	[[noreturn]] void set_error(Error&& /*error*/) noexcept {
+		std::terminate();
+	}
+
+	void set_stopped() noexcept { m_opState->m_complete(m_opState); }
+
+	[[nodiscard]] auto get_env() const noexcept -> qobject_scope_env;
+
+	scope_op_base* m_opState;
+};
+
+template <class... Errors>
+using error_count = std::integral_constant<std::size_t, sizeof...(Errors)>;
+
+// Senders that can be spawned in a QObjectScope. set_error of the scope
+// terminates, so senders that may complete with an error are rejected.
+template <class Sender>
+concept scope_spawnable =
+    stdexec::sender_to<Sender, scope_receiver> &&
+    stdexec::error_types_of_t<Sender, qobject_scope_env, error_count>::value == 0;
+
+// Operation state of a spawned sender, it lives in the arena of the scope
+// and destroys itself on completion
+template <class Sender>
+struct scope_op_state : scope_op_base {
+	scope_op_state(qobject_scope_state* scope, Sender&& sender)
+	    : scope_op_base{scope, &complete},
+	      m_opState(stdexec::connect(std::forward<Sender>(sender),
+	                                 scope_receiver{this})) {}
+
+	scope_op_state(const scope_op_state&) = delete;
+	scope_op_state(scope_op_state&&)      = delete;
+
+	static void complete(scope_op_base* base) noexcept;
+
+	stdexec::connect_result_t<Sender, scope_receiver> m_opState;
+};
+
+// State of a QObjectScope. It lives until the scope is destroyed and its last
+// operation completed, whichever happens later.
+class qobject_scope_state {
+public:
+	template <class Sender>
+	void spawn(Sender&& sender) {
+		using op_state = scope_op_state<Sender>;
+		void* memory   = nullptr;
+		{
+			const std::lock_guard lock(m_mutex);
+			memory = m_arena.allocate(sizeof(op_state), alignof(op_state));
+			++m_active;
+		}
+		op_state* opState = nullptr;
+		try {
+			opState = ::new (memory) op_state(this, std::forward<Sender>(sender));
+		} catch (...) {
+			release(memory, sizeof(op_state), alignof(op_state));
+			throw;
+		}
+		stdexec::start(opState->m_opState);
+	}
+
+	// Returns the memory of a completed operation
+	void release(void* memory, std::size_t size, std::size_t alignment) noexcept {
+		bool destroy = false;
+		{
+			const std::lock_guard lock(m_mutex);
+			m_arena.deallocate(memory, size, alignment);
+			if (--m_active == 0) {
+				m_arena.reset();
+				destroy = m_detached;
+			}
+		}
+		if (destroy) {
+			delete this;
+		}
+	}
+
+	// Called by the destructor of the scope, the state follows once the last
+	// operation completed
+	void detach() noexcept {
+		bool destroy = false;
+		{
+			const std::lock_guard lock(m_mutex);
+			m_detached = true;
+			destroy    = m_active == 0;
+		}
+		if (destroy) {
+			delete this;
+		}
+	}
+
+	void request_stop() noexcept { m_stopSource.request_stop(); }
+
+	[[nodiscard]] auto get_stop_token() const noexcept
+	    -> stdexec::inplace_stop_token {
+		return m_stopSource.get_token();
+	}
+
+	[[nodiscard]] auto active() const noexcept -> std::size_t {
+		const std::lock_guard lock(m_mutex);
+		return m_active;
+	}
+
+private:
+	mutable std::mutex           m_mutex;
+	scope_arena                  m_arena;
+	std::size_t                  m_active{0};
+	bool                         m_detached{false};
+	stdexec::inplace_stop_source m_stopSource;
+};
+
+inline auto scope_receiver::get_env() const noexcept -> qobject_scope_env {
+	return {m_opState->m_scope->get_stop_token()};
+}
+
+template <class Sender>
+void scope_op_state<Sender>::complete(scope_op_base* base) noexcept {
+	auto* const self  = static_cast<scope_op_state*>(base);
+	auto* const scope = self->m_scope;
+	self->~scope_op_state();
+	scope->release(self, sizeof(scope_op_state), alignof(scope_op_state));
+}
+} // namespace detail
+
+// Async scope that belongs to a QObject. Stop is requested for all of its
+// work when the object is destroyed, or when the scope is destroyed first,
+// e.g. as a member of the object. The work then completes on its own, the
+// scope does not wait for it.
+//
+// The operation states of spawned work are allocated from an arena of the
+// scope that is rewound whenever no work is left, so spawning stops
+// allocating once the scope saw its peak of outstanding work.
+//
+// The scope must be destroyed on the thread of the object. Work that no
+// longer observes stop requests, like a continuation that already started,
+// still runs to its end.
+class QObjectScope {
+public:
+	explicit QObjectScope(QObject* object)
+	    : m_state(new detail::qobject_scope_state()) {
+		m_destroyedConnection =
+		    QObject::connect(object, &QObject::destroyed,
+		                     [state = m_state]() { state->request_stop(); });
+	}
+
+	QObjectScope(const QObjectScope&)            = delete;
+	QObjectScope& operator=(const QObjectScope&) = delete;
+
+	~QObjectScope() {
+		QObject::disconnect(m_destroyedConnection);
+		m_state->request_stop();
+		m_state->detach();
+	}
+
+	// Starts the sender, its values are dropped. Senders that may complete
+	// with an error are rejected, handle the errors with upon_error or
+	// let_error first. Note that then() with a callable that is not noexcept
+	// may complete with an exception_ptr.
+	template <detail::scope_spawnable Sender>
+	void spawn(Sender&& sender) {
+		m_state->spawn(std::forward<Sender>(sender));
+	}
+
+	void request_stop() noexcept { m_state->request_stop(); }
+
+	[[nodiscard]] auto get_stop_token() const noexcept
+	    -> stdexec::inplace_stop_token {
+		return m_state->get_stop_token();
+	}
+
+	// Number of spawned operations that did not complete yet
+	[[nodiscard]] auto active() const noexcept -> std::size_t {
+		return m_state->active();
+	}
+
+private:
+	detail::qobject_scope_state* const m_state;
+	QMetaObject::Connection            m_destroyedConnection;
+};
+
+} // namespace stdexecutils::qt
+
+#endif // STDEXEC_UTILS_QOBJECT_SCOPE_HPP
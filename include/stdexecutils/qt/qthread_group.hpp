@@ -0,0 +1,169 @@
+#ifndef STDEXEC_UTILS_QTHREAD_GROUP_HPP
+#define STDEXEC_UTILS_QTHREAD_GROUP_HPP
+
+#include <stdexecutils/qt/detail/qthread_group_context.hpp>
+#include <stdexecutils/qt/tracing.hpp>
+
+#include <QThread>
+
+#ifndef Q_MOC_RUN
+#include <stdexec/execution.hpp>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+namespace stdexecutils::qt {
+
+// Scheduler of a QThreadGroup.
+//
+// schedule() runs the work on any thread of the group, idle threads steal it
+// from busy ones. schedule_on_least_loaded() runs it on the thread with the
+// fewest queued tasks and never moves it, use it for work that creates
+// QObjects which have to stay on that thread.
+class QThreadGroupScheduler {
+public:
+	using __id = QThreadGroupScheduler;
+	using __t  = QThreadGroupScheduler;
+
+	struct env {
+		explicit env(detail::qthread_group_context* context) noexcept
+		    : m_context(context) {}
+
+		template <stdexec::__completion_tag Tag>
+		auto query(stdexec::get_completion_scheduler_t<Tag>) const noexcept
+		    -> QThreadGroupScheduler {
+			return QThreadGroupScheduler{m_context};
+		}
+
+	private:
+		detail::qthread_group_context* const m_context;
+	};
+
+	template <class Recv>
+	struct op_state : public detail::run_queue_task {
+		op_state(Recv&& receiver, detail::qthread_group_context* context,
+		         bool leastLoaded)
+		    : detail::run_queue_task(&op_state::execute),
+		      m_receiver(std::move(receiver)), m_context(context),
+		      m_leastLoaded(leastLoaded) {}
+
+		op_state(const op_state&) = delete;
+		op_state(op_state&&)      = delete;
+
+		void start() noexcept {
+			stdexec::stoppable_token auto stop_token =
+			    stdexec::get_stop_token(stdexec::get_env(m_receiver));
+			if (stop_token.stop_requested()) {
+				stdexec::set_stopped(std::move(m_receiver));
+				return;
+			}
+			detail::trace_enqueue(this, stdexec::get_env(m_receiver));
+			if (m_leastLoaded) {
+				m_context->push_least_loaded(this);
+			} else {
+				m_context->push(this);
+			}
+		}
+
+	private:
+		static void execute(detail::run_queue_task* task, bool stopped) noexcept {
+			auto&                   self = *static_cast<op_state*>(task);
+			const detail::trace_run trace(&self);
+			if (stopped || stdexec::get_stop_token(stdexec::get_env(self.m_receiver))
+			                   .stop_requested()) {
+				stdexec::set_stopped(std::move(self.m_receiver));
+				return;
+			}
+			stdexec::set_value(std::move(self.m_receiver));
+		}
+
+		Recv                                 m_receiver;
+		detail::qthread_group_context* const m_context;
+		const bool                           m_leastLoaded;
+	};
+
+	struct sender {
+		using __id = sender;
+		using __t  = sender;
+
+		using sender_concept        = stdexec::sender_t;
+		using completion_signatures = stdexec::completion_signatures< //
+		    stdexec::set_value_t(),                                   //
+		    stdexec::set_stopped_t()>;
+
+		sender(detail::qthread_group_context* context, bool leastLoaded) noexcept
+		    : m_context(context), m_leastLoaded(leastLoaded) {}
+
+		template <class R>
+		auto connect(R r) const -> op_state<R> {
+			return op_state<R>(std::move(r), m_context, m_leastLoaded);
+		};
+
+		auto get_env() const noexcept -> env { return env{m_context}; }
+
+	private:
+		detail::qthread_group_context* const m_context;
+		const bool                           m_leastLoaded;
+	};
+
+	auto schedule() const noexcept -> sender { return sender{m_context, false}; }
+
+	auto schedule_on_least_loaded() const noexcept -> sender {
+		return sender{m_context, true};
+	}
+
+	auto operator==(const QThreadGroupScheduler&) const noexcept
+	    -> bool = default;
+
+private:
+	friend class QThreadGroup;
+
+	explicit QThreadGroupScheduler(
+	    detail::qthread_group_context* context) noexcept
+	    : m_context(context) {}
+
+	detail::qthread_group_context* m_context;
+};
+
+// Owns a group of QThreads that each run an event loop. The threads are
+// started by the constructor and stopped by the destructor, work that did not
+// start by then completes with set_stopped.
+class QThreadGroup {
+public:
+	// With pinThreads the i-th thread is bound to the i-th CPU of the affinity
+	// mask of the process, this is only supported on Linux and ignored
+	// elsewhere. A thread that can't be pinned runs unpinned with a warning.
+	explicit QThreadGroup(int  threadCount = QThread::idealThreadCount(),
+	                      bool pinThreads  = false)
+	    : m_context(std::make_unique<detail::qthread_group_context>(
+	          static_cast<std::size_t>(std::max(threadCount, 1)), pinThreads)) {}
+
+	QThreadGroup(const QThreadGroup&) = delete;
+	QThreadGroup(QThreadGroup&&)      = delete;
+
+	~QThreadGroup() = default;
+
+	[[nodiscard]] auto get_scheduler() const noexcept -> QThreadGroupScheduler {
+		return QThreadGroupScheduler{m_context.get()};
+	}
+
+	[[nodiscard]] auto size() const noexcept -> std::size_t {
+		return m_context->size();
+	}
+
+	[[nodiscard]] auto thread(std::size_t index) const noexcept -> QThread* {
+		return m_context->thread(index);
+	}
+
+	// Queued and running tasks of a thread
+	[[nodiscard]] auto load(std::size_t index) const noexcept -> std::size_t {
+		return m_context->load(index);
+	}
+
+private:
+	std::unique_ptr<detail::qthread_group_context> m_context;
+};
+} // namespace stdexecutils::qt
+#endif
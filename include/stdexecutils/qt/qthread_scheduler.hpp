@@ -1,46 +1,177 @@
 #ifndef STDEXEC_UTILS_QTHREAD_SCHEDULER_HPP
 #define STDEXEC_UTILS_QTHREAD_SCHEDULER_HPP
 
-#include <QAbstractEventDispatcher>
-#include <QBasicTimer>
+#include <stdexecutils/qt/detail/qthread_context.hpp>
+#include <stdexecutils/qt/queries.hpp>
+#include <stdexecutils/qt/tracing.hpp>
+
 #include <QObject>
 #include <QThread>
-#include <QTimerEvent>
 #include <stdexec/__detail/__execution_fwd.hpp>
 
 #ifndef Q_MOC_RUN
 #include <stdexec/execution.hpp>
 #endif
 
+#include <atomic>
 #include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <exception>
 #include <optional>
+#include <tuple>
+#include <type_traits>
+#include <variant>
 
 namespace stdexecutils::qt {
+class QThreadScheduler;
+
+namespace detail {
+
+// State shared by QThreadScheduler and its senders
+struct qthread_scheduler_params {
+	QThread*          thread;
+	qthread_context*  context;
+	Qt::TimerType     timerType;
+	Qt::EventPriority priority;
+
+	auto operator==(const qthread_scheduler_params&) const noexcept
+	    -> bool = default;
+};
+
+template <class Scheduler, class Sender>
+struct qthread_continues_on_sender;
+
+template <class Sender>
+struct qthread_starts_on_sender;
+
+// Scheduler that may refer to a QThreadScheduler, like the type-erased
+// scheduler that exec::task transitions back to after each co_await
+template <class Scheduler>
+concept qthread_wrapping_scheduler =
+    std::constructible_from<Scheduler, const QThreadScheduler&> &&
+    std::equality_comparable<Scheduler>;
+
+// Scheduler of a transition that the domain replaces
+template <class Scheduler>
+concept qthread_transition_target =
+    std::same_as<Scheduler, QThreadScheduler> ||
+    qthread_wrapping_scheduler<Scheduler>;
+
+// Replaces continues_on, schedule_from and starts_on to a QThreadScheduler
+// with senders that skip the hop through the event loop when they already
+// run on the thread of the scheduler.
+//
+// Transitions from a sender that completes on a QThreadScheduler reach the
+// domain as well. When their scheduler wraps the same QThreadScheduler, they
+// skip the hop too. This is the co_await of such a sender in exec::task: the
+// task transitions back to its scheduler, which it keeps type-erased.
+struct qthread_domain : stdexec::default_domain {
+	struct transform_continues_on {
+		template <class Tag, class Scheduler, class Sender>
+		auto operator()(Tag, Scheduler&& scheduler, Sender&& sender) const {
+			using scheduler_t = std::decay_t<Scheduler>;
+			using sender_t    = qthread_continues_on_sender<scheduler_t,
+			                                                std::decay_t<Sender>>;
+			if constexpr (std::same_as<scheduler_t, QThreadScheduler>) {
+				return sender_t{scheduler, scheduler, std::forward<Sender>(sender)};
+			} else {
+				std::optional<QThreadScheduler> inlineOn;
+				if constexpr (requires {
+					              QThreadScheduler{
+					                  stdexec::get_completion_scheduler<
+					                      stdexec::set_value_t>(
+					                      stdexec::get_env(sender))};
+				              }) {
+					const QThreadScheduler from =
+					    stdexec::get_completion_scheduler<stdexec::set_value_t>(
+					        stdexec::get_env(sender));
+					if (scheduler_t(from) == scheduler) {
+						inlineOn = from;
+					}
+				}
+				return sender_t{std::forward<Scheduler>(scheduler), inlineOn,
+				                std::forward<Sender>(sender)};
+			}
+		}
+	};
+
+	struct transform_starts_on {
+		template <class Tag, class Scheduler, class Sender>
+		auto operator()(Tag, Scheduler&& scheduler, Sender&& sender) const {
+			return qthread_starts_on_sender<std::decay_t<Sender>>{
+			    std::forward<Scheduler>(scheduler), std::forward<Sender>(sender)};
+		}
+	};
+
+	template <class Sender>
+	static constexpr bool is_transition =
+	    (stdexec::sender_expr_for<Sender, stdexec::continues_on_t> ||
+	     stdexec::sender_expr_for<Sender, stdexec::schedule_from_t>) &&
+	    qthread_transition_target<std::decay_t<stdexec::__data_of<Sender>>>;
+
+	template <class Sender>
+	    requires is_transition<Sender>
+	auto transform_sender(Sender&& sender) const {
+		return stdexec::__sexpr_apply(std::forward<Sender>(sender),
+		                              transform_continues_on{});
+	}
+
+	template <class Sender, class Env>
+	    requires is_transition<Sender>
+	auto transform_sender(Sender&& sender, const Env& /*env*/) const {
+		return transform_sender(std::forward<Sender>(sender));
+	}
+
+	template <stdexec::sender_expr_for<stdexec::starts_on_t> Sender>
+	auto transform_sender(Sender&& sender) const {
+		return stdexec::__sexpr_apply(std::forward<Sender>(sender),
+		                              transform_starts_on{});
+	}
+
+	template <stdexec::sender_expr_for<stdexec::starts_on_t> Sender, class Env>
+	auto transform_sender(Sender&& sender, const Env& /*env*/) const {
+		return transform_sender(std::forward<Sender>(sender));
+	}
+};
+} // namespace detail
 
 class QThreadScheduler {
 public:
 	using __id = QThreadScheduler;
 	using __t  = QThreadScheduler;
 
+	using deadline_or_delay =
+	    std::variant<std::chrono::system_clock::time_point,
+	                 std::chrono::steady_clock::time_point,
+	                 std::chrono::steady_clock::duration>;
+
 	struct env {
 
-		explicit env(QThread* thread) noexcept : m_thread(thread) {}
+		explicit env(const detail::qthread_scheduler_params& params) noexcept
+		    : m_params(params) {}
 
 		template <stdexec::__completion_tag Tag>
 		auto query(stdexec::get_completion_scheduler_t<Tag>) const noexcept
 		    -> QThreadScheduler {
-			return QThreadScheduler{m_thread};
+			return QThreadScheduler{m_params};
+		}
+
+		auto query(get_priority_t) const noexcept -> Qt::EventPriority {
+			return m_params.priority;
 		}
 
 	private:
-		QThread* const m_thread;
+		const detail::qthread_scheduler_params m_params;
 	};
 
 	// Sender for schedule
 	template <class Recv>
-	struct op_state {
-		op_state(Recv&& receiver, QThread* thread)
-		    : m_receiver(std::move(receiver)), m_thread(thread) {}
+	struct op_state : public detail::run_queue_task {
+		op_state(Recv&& receiver, const detail::qthread_scheduler_params& params)
+		    : detail::run_queue_task(&op_state::execute),
+		      m_receiver(std::move(receiver)), m_context(params.context),
+		      m_priority(params.priority) {}
 
 		op_state(const op_state&) = delete;
 		op_state(op_state&&)      = delete;
@@ -52,21 +183,25 @@ public:
 				stdexec::set_stopped(std::move(m_receiver));
 				return;
 			}
-			QMetaObject::invokeMethod(
-			    m_thread->eventDispatcher(),
-			    [this, stop_token]() {
-				    if (stop_token.stop_requested()) {
-					    stdexec::set_stopped(std::move(m_receiver));
-					    return;
-				    }
-				    stdexec::set_value(std::move(m_receiver));
-			    },
-			    Qt::QueuedConnection);
+			detail::trace_enqueue(this, stdexec::get_env(m_receiver));
+			m_context->push(this, m_priority);
 		}
 
 	private:
-		Recv           m_receiver;
-		QThread* const m_thread;
+		static void execute(detail::run_queue_task* task, bool stopped) noexcept {
+			auto&                   self = *static_cast<op_state*>(task);
+			const detail::trace_run trace(&self);
+			if (stopped || stdexec::get_stop_token(stdexec::get_env(self.m_receiver))
+			                   .stop_requested()) {
+				stdexec::set_stopped(std::move(self.m_receiver));
+				return;
+			}
+			stdexec::set_value(std::move(self.m_receiver));
+		}
+
+		Recv                           m_receiver;
+		detail::qthread_context* const m_context;
+		const Qt::EventPriority        m_priority;
 	};
 	struct sender {
 		using __id = sender;
@@ -77,33 +212,34 @@ public:
 		    stdexec::set_value_t(),                                   //
 		    stdexec::set_stopped_t()>;
 
-		explicit sender(QThread* thread) noexcept : m_thread(thread) {}
+		explicit sender(const detail::qthread_scheduler_params& params) noexcept
+		    : m_params(params) {}
 
 		template <class R>
 		auto connect(R r) const -> op_state<R> {
-			return op_state<R>(std::move(r), m_thread);
+			return op_state<R>(std::move(r), m_params);
 		};
 
-		auto get_env() const noexcept -> env { return env{m_thread}; }
+		auto get_env() const noexcept -> env { return env{m_params}; }
 
 	private:
-		QThread* const m_thread;
+		const detail::qthread_scheduler_params m_params;
 	};
 
 	// Operation state for schedule_at and scheduler_after
 	template <class Recv>
-	struct timeout_op_state : public QObject {
+	struct timeout_op_state : public detail::timer_node {
 
-		using deadline_or_delay =
-		    std::variant<std::chrono::system_clock::time_point,
-		                 std::chrono::system_clock::duration>;
-
-		timeout_op_state(Recv&& receiver, QThread* thread,
+		timeout_op_state(Recv&&                                  receiver,
+		                 const detail::qthread_scheduler_params& params,
 		                 deadline_or_delay deadlineOrDelay)
-		    : QObject(nullptr), m_receiver(std::move(receiver)),
-		      m_deadlineOrDelay(deadlineOrDelay) {
-			moveToThread(thread);
-		}
+		    : detail::timer_node(&timeout_op_state::fire),
+		      m_receiver(std::move(receiver)), m_context(params.context),
+		      m_timerType(params.timerType), m_priority(params.priority),
+		      m_deadlineOrDelay(deadlineOrDelay) {}
+
+		timeout_op_state(const timeout_op_state&) = delete;
+		timeout_op_state(timeout_op_state&&)      = delete;
 
 		void start() noexcept {
 			stdexec::stoppable_token auto stop_token =
@@ -113,79 +249,130 @@ public:
 				stdexec::set_stopped(std::move(m_receiver));
 				return;
 			}
-			connect(qApp, &QCoreApplication::aboutToQuit, this,
-			        &timeout_op_state::handle_stopped);
-			connect(thread(), &QThread::finished, this,
-			        &timeout_op_state::handle_stopped);
-
-			const auto intervalFromNow =
-			    std::holds_alternative<std::chrono::system_clock::time_point>(
-			        m_deadlineOrDelay)
-			        ? std::chrono::duration_cast<std::chrono::milliseconds>(
-			              std::get<std::chrono::system_clock::time_point>(
-			                  m_deadlineOrDelay) -
-			              std::chrono::system_clock::now())
-			        : std::chrono::duration_cast<std::chrono::milliseconds>(
-			              std::get<std::chrono::system_clock::duration>(
-			                  m_deadlineOrDelay));
-
-			if (intervalFromNow.count() < 0) {
-				QMetaObject::invokeMethod(
-				    this, [this]() { stdexec::set_value(std::move(m_receiver)); },
-				    Qt::QueuedConnection);
-				return;
+
+			using clock = detail::qthread_context::clock;
+			if (const auto* const wallDeadline =
+			        std::get_if<std::chrono::system_clock::time_point>(
+			            &m_deadlineOrDelay)) {
+				// Wall-clock deadlines are converted once, adjustments of the system
+				// clock after the start don't move them
+				m_deadline = clock::now() +
+				             std::chrono::duration_cast<clock::duration>(
+				                 *wallDeadline - std::chrono::system_clock::now());
+			} else if (const auto* const deadline =
+			               std::get_if<clock::time_point>(&m_deadlineOrDelay)) {
+				m_deadline = *deadline;
+			} else {
+				m_deadline =
+				    clock::now() + std::get<clock::duration>(m_deadlineOrDelay);
 			}
 
-			m_timer.start(intervalFromNow, this);
+			detail::trace_enqueue(this, stdexec::get_env(m_receiver));
+			// The timer wheel belongs to the thread of the context
+			if (QThread::currentThread() == m_context->thread()) {
+				arm();
+			} else {
+				m_context->push(&m_armTask, m_priority);
+			}
+		}
+
+	private:
+		struct task : public detail::run_queue_task {
+			task(timeout_op_state& opState, execute_fn execute) noexcept
+			    : detail::run_queue_task(execute), op_state(opState) {}
+
+			timeout_op_state& op_state;
+		};
+
+		struct stop_callback_fun {
+			timeout_op_state& op_state;
+
+			void operator()() noexcept {
+				// Only the thread of the context may touch the timer wheel
+				if (!op_state.m_cancelQueued.exchange(true,
+				                                      std::memory_order_acq_rel)) {
+					op_state.m_context->push(&op_state.m_cancelTask,
+					                         op_state.m_priority);
+				}
+			}
+		};
+
+		void arm() noexcept {
+			m_context->add_timer(this, m_deadline, m_timerType);
+			stdexec::stoppable_token auto stop_token =
+			    stdexec::get_stop_token(stdexec::get_env(m_receiver));
 			if (stop_token.stop_possible()) {
 				m_stoppedCallback.emplace(std::move(stop_token),
 				                          stop_callback_fun{*this});
 			}
 		}
 
-	private:
-		void timerEvent(QTimerEvent* ev) override {
-#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
-			assert(ev->id() == m_timer.id());
-#endif
-			if (m_done) {
-				return;
+		void complete(bool stopped) noexcept {
+			const detail::trace_run trace(this);
+			if (stopped) {
+				stdexec::set_stopped(std::move(m_receiver));
+			} else {
+				stdexec::set_value(std::move(m_receiver));
 			}
-			m_done = true;
-			m_timer.stop();
-			stdexec::set_value(std::move(m_receiver));
 		}
 
-		struct stop_callback_fun {
-			timeout_op_state& op_state;
+		static void on_arm(detail::run_queue_task* armTask,
+		                   bool                    stopped) noexcept {
+			auto& self = static_cast<task*>(armTask)->op_state;
+			if (stopped) {
+				self.complete(true);
+				return;
+			}
+			self.arm();
+		}
 
-			void operator()() {
-				QMetaObject::invokeMethod(&op_state,
-				                          [this]() { op_state.handle_stopped(); });
+		// Called by the timer wheel when the deadline expired, or with stopped
+		// when the thread or application shuts down
+		static void fire(detail::timer_node* node, bool stopped) noexcept {
+			auto& self = *static_cast<timeout_op_state*>(node);
+			if (!stopped) {
+				self.m_context->metrics().timer_started(self.m_deadline);
 			}
-		};
-	private Q_SLOTS:
-		void handle_stopped() {
-			if (m_done) {
+			// Waits for a concurrently running stop callback
+			self.m_stoppedCallback.reset();
+			if (self.m_cancelQueued.load(std::memory_order_acquire)) {
+				// The cancel task still references this operation state, it
+				// completes once it ran
+				self.m_firedStopped = stopped;
 				return;
 			}
-			m_done = true;
-			m_timer.stop();
-			stdexec::set_stopped(std::move(m_receiver));
+			self.complete(stopped);
+		}
+
+		static void on_cancel(detail::run_queue_task* cancelTask,
+		                      bool /*stopped*/) noexcept {
+			auto& self = static_cast<task*>(cancelTask)->op_state;
+			if (self.m_context->remove_timer(&self, self.m_timerType)) {
+				self.m_stoppedCallback.reset();
+				self.complete(true);
+				return;
+			}
+			// The timer already fired and deferred its completion
+			self.complete(self.m_firedStopped);
 		}
 
-		friend struct stop_callback_fun;
 		using stop_callback = stdexec::stop_callback_for_t<
 		    stdexec::stop_token_of_t<stdexec::env_of_t<Recv>>, stop_callback_fun>;
 
-		Recv                         m_receiver;
-		const deadline_or_delay      m_deadlineOrDelay;
-		QBasicTimer                  m_timer;
-		bool                         m_done{false};
-		std::optional<stop_callback> m_stoppedCallback;
+		Recv                                       m_receiver;
+		detail::qthread_context* const             m_context;
+		const Qt::TimerType                        m_timerType;
+		const Qt::EventPriority                    m_priority;
+		const deadline_or_delay                    m_deadlineOrDelay;
+		detail::qthread_context::clock::time_point m_deadline;
+		task                                       m_armTask{*this, &on_arm};
+		task                                       m_cancelTask{*this, &on_cancel};
+		std::atomic<bool>                          m_cancelQueued{false};
+		bool                                       m_firedStopped{false};
+		std::optional<stop_callback>               m_stoppedCallback;
 	};
 
-	// Sender for schedule_at
+	// Sender for schedule_at and schedule_after
 	struct timeout_sender {
 		using __id = timeout_sender;
 		using __t  = timeout_sender;
@@ -195,69 +382,485 @@ public:
 		    stdexec::set_value_t(),                                   //
 		    stdexec::set_stopped_t()>;
 
-		explicit timeout_sender(
-		    QThread*                              thread,
-		    std::chrono::system_clock::time_point deadline) noexcept
-		    : m_thread(thread), m_deadline(deadline) {}
+		timeout_sender(const detail::qthread_scheduler_params& params,
+		               deadline_or_delay deadlineOrDelay) noexcept
+		    : m_params(params), m_deadlineOrDelay(deadlineOrDelay) {}
 
 		template <class R>
 		auto connect(R r) const -> timeout_op_state<R> {
-			return timeout_op_state<R>(std::move(r), m_thread, m_deadline);
+			return timeout_op_state<R>(std::move(r), m_params, m_deadlineOrDelay);
 		};
 
-		auto get_env() const noexcept -> env { return env{m_thread}; }
+		auto get_env() const noexcept -> env { return env{m_params}; }
 
 	private:
-		QThread* const                              m_thread;
-		const std::chrono::system_clock::time_point m_deadline;
+		const detail::qthread_scheduler_params m_params;
+		const deadline_or_delay                m_deadlineOrDelay;
 	};
+	using delay_sender = timeout_sender;
+
+	// The timer type selects the precision of schedule_at and schedule_after:
+	// Qt::PreciseTimer for latency sensitive wakeups, Qt::CoarseTimer and
+	// Qt::VeryCoarseTimer let the system coalesce wakeups to save power.
+	// The event priority orders the work of this scheduler against other
+	// events posted to the thread. Only Qt::LowEventPriority,
+	// Qt::NormalEventPriority and Qt::HighEventPriority are distinguished,
+	// priorities below or above are treated as the lowest or highest of them.
+	explicit QThreadScheduler(QThread*      thread,
+	                          Qt::TimerType timerType = Qt::CoarseTimer) noexcept
+	    : QThreadScheduler(thread, Qt::NormalEventPriority, timerType) {}
+	QThreadScheduler(QThread* thread, Qt::EventPriority priority,
+	                 Qt::TimerType timerType = Qt::CoarseTimer) noexcept
+	    : m_params{thread, detail::qthread_context::for_thread(thread),
+	               timerType, priority} {}
+	explicit QThreadScheduler(QObject*      object,
+	                          Qt::TimerType timerType = Qt::CoarseTimer) noexcept
+	    : QThreadScheduler(object->thread(), timerType) {}
+	QThreadScheduler(QObject* object, Qt::EventPriority priority,
+	                 Qt::TimerType timerType = Qt::CoarseTimer) noexcept
+	    : QThreadScheduler(object->thread(), priority, timerType) {}
+
+	auto schedule() const -> sender { return sender{m_params}; }
+
+	[[nodiscard]] auto now() const noexcept
+	    -> std::chrono::steady_clock::time_point {
+		return std::chrono::steady_clock::now();
+	}
 
-	// Sender for schedule_after
-	struct delay_sender {
-		using __id = delay_sender;
-		using __t  = delay_sender;
+	auto schedule_at(std::chrono::system_clock::time_point deadline) const
+	    -> timeout_sender {
+		return timeout_sender{m_params, deadline};
+	};
 
-		using sender_concept        = stdexec::sender_t;
-		using completion_signatures = stdexec::completion_signatures< //
-		    stdexec::set_value_t(),                                   //
-		    stdexec::set_stopped_t()>;
+	auto schedule_at(std::chrono::steady_clock::time_point deadline) const
+	    -> timeout_sender {
+		return timeout_sender{m_params, deadline};
+	};
 
-		explicit delay_sender(QThread*                            thread,
-		                      std::chrono::system_clock::duration duration) noexcept
-		    : m_thread(thread), m_duration(duration) {}
+	auto schedule_after(std::chrono::steady_clock::duration delay) const
+	    -> timeout_sender {
+		return timeout_sender{m_params, delay};
+	};
 
-		template <class R>
-		auto connect(R r) const -> timeout_op_state<R> {
-			return timeout_op_state<R>(std::move(r), m_thread, m_duration);
-		};
+	// Starts recording the metrics of the thread, for all its schedulers.
+	// Work queued before is not counted.
+	void enable_metrics() const noexcept {
+		m_params.context->metrics().enable();
+	}
+
+	// Metrics of the thread, they are shared by all schedulers of the thread.
+	// They stay empty unless enable_metrics() was called.
+	[[nodiscard]] auto metrics() const noexcept -> scheduler_metrics {
+		return m_params.context->metrics().snapshot();
+	}
+
+	[[nodiscard]] auto timer_type() const noexcept -> Qt::TimerType {
+		return m_params.timerType;
+	}
+
+	auto query(get_priority_t) const noexcept -> Qt::EventPriority {
+		return m_params.priority;
+	}
+
+	[[nodiscard]] auto query(stdexec::get_domain_t) const noexcept
+	    -> detail::qthread_domain {
+		return {};
+	}
+
+	// Wakes the thread through an eventfd watched by a QSocketNotifier instead
+	// of posted events, for every scheduler of the thread. Wakeups no longer
+	// allocate, but the event priorities only order the work of the schedulers
+	// among themselves. It lasts until the thread finishes. Returns false where
+	// it is not supported, only Linux has eventfd.
+	static auto enable_eventfd_wakeup(QThread* thread) -> bool {
+		return detail::qthread_context::for_thread(thread)
+		    ->enable_eventfd_wakeup();
+	}
+
+	// Whether the thread of the scheduler is woken through the eventfd
+	[[nodiscard]] auto eventfd_wakeup() const noexcept -> bool {
+		return m_params.context->eventfd_wakeup();
+	}
+
+	// Whether the calling thread is the thread of the scheduler
+	[[nodiscard]] auto on_thread() const noexcept -> bool {
+		return QThread::currentThread() == m_params.thread;
+	}
 
-		auto get_env() const noexcept -> env { return env{m_thread}; }
+	auto operator==(const QThreadScheduler&) const noexcept -> bool = default;
 
-	private:
-		QThread* const                            m_thread;
-		const std::chrono::system_clock::duration m_duration;
+private:
+	explicit QThreadScheduler(
+	    const detail::qthread_scheduler_params& params) noexcept
+	    : m_params(params) {}
+
+	detail::qthread_scheduler_params m_params;
+};
+
+namespace detail {
+
+// Completions that already run on the thread of the scheduler are passed on
+// inline. Inline completions may start further work that completes inline
+// too, past this depth the next one goes through the run queue and unwinds
+// the stack.
+inline constexpr std::size_t max_inline_depth = 64;
+
+inline auto inline_depth() noexcept -> std::size_t& {
+	thread_local std::size_t depth = 0;
+	return depth;
+}
+
+// Runs fun inline when the calling thread is the thread of the scheduler and
+// the inline depth allows it
+template <class Fun>
+auto try_run_inline(const QThreadScheduler& scheduler, Fun&& fun) noexcept
+    -> bool {
+	auto& depth = inline_depth();
+	if (depth >= max_inline_depth || !scheduler.on_thread()) {
+		return false;
+	}
+	++depth;
+	std::forward<Fun>(fun)();
+	--depth;
+	return true;
+}
+
+template <class... Ts>
+struct completion_list {};
+
+template <class... Ts>
+using value_completion = std::tuple<stdexec::set_value_t, std::decay_t<Ts>...>;
+
+template <class... Errors>
+using error_completions =
+    completion_list<std::tuple<stdexec::set_error_t, std::decay_t<Errors>>...>;
+
+template <class Values, class Errors>
+struct completions_variant;
+
+template <class... Values, class... Errors>
+struct completions_variant<completion_list<Values...>,
+                           completion_list<Errors...>> {
+	using type = std::variant<std::monostate, Values..., Errors...,
+	                          std::tuple<stdexec::set_stopped_t>>;
+};
+
+// Any completion of a sender, tagged with its channel
+template <class Sender, class Env>
+using completions_variant_t = typename completions_variant<
+    stdexec::value_types_of_t<Sender, Env, value_completion, completion_list>,
+    stdexec::error_types_of_t<Sender, Env, error_completions>>::type;
+
+template <class... Ts>
+using decayed_value_signature =
+    stdexec::completion_signatures<stdexec::set_value_t(std::decay_t<Ts>...)>;
+
+template <class Error>
+using decayed_error_signature =
+    stdexec::completion_signatures<stdexec::set_error_t(std::decay_t<Error>)>;
+
+// Operation state of continues_on and schedule_from to a QThreadScheduler,
+// or to a scheduler that wraps the QThreadScheduler of the predecessor. The
+// completion of the predecessor is passed on inline when it runs on the
+// thread of that QThreadScheduler, otherwise it is kept here and passed on by
+// a schedule() operation that is connected in place.
+template <class Scheduler, class Sender, class Recv>
+struct qthread_continues_on_op_state {
+	struct child_receiver {
+		using receiver_concept = stdexec::receiver_t;
+
+		template <class... Args>
+		void set_value(Args&&... args) noexcept {
+			m_opState->arrive(stdexec::set_value, std::forward<Args>(args)...);
+		}
+
+		template <class Error>
+		void set_error(Error&& error) noexcept {
+			m_opState->arrive(stdexec::set_error, std::forward<Error>(error));
+		}
+
+		void set_stopped() noexcept { m_opState->arrive(stdexec::set_stopped); }
+
+		[[nodiscard]] auto get_env() const noexcept -> stdexec::env_of_t<Recv> {
+			return stdexec::get_env(m_opState->m_recv);
+		}
+
+		qthread_continues_on_op_state* m_opState;
 	};
 
-	explicit QThreadScheduler(QThread* thread) noexcept : m_thread(thread) {}
-	explicit QThreadScheduler(QObject* object) noexcept
-	    : m_thread(object->thread()) {}
+	struct hop_receiver {
+		using receiver_concept = stdexec::receiver_t;
 
-	auto schedule() const -> sender { return sender{m_thread}; }
+		void set_value() noexcept { m_opState->deliver(); }
 
-	auto schedule_at(std::chrono::system_clock::time_point deadline) const
-	    -> timeout_sender {
-		return timeout_sender{m_thread, deadline};
+		// The schedule() of a wrapping scheduler may fail
+		template <class Error>
+		void set_error(Error&& error) noexcept {
+			stdexec::set_error(std::move(m_opState->m_recv),
+			                   std::forward<Error>(error));
+		}
+
+		void set_stopped() noexcept {
+			stdexec::set_stopped(std::move(m_opState->m_recv));
+		}
+
+		[[nodiscard]] auto get_env() const noexcept -> stdexec::env_of_t<Recv> {
+			return stdexec::get_env(m_opState->m_recv);
+		}
+
+		qthread_continues_on_op_state* m_opState;
+	};
+
+	qthread_continues_on_op_state(const Scheduler&                       scheduler,
+	                              const std::optional<QThreadScheduler>& inlineOn,
+	                              Sender&& sender, Recv recv)
+	    : m_recv(std::move(recv)), m_inlineOn(inlineOn),
+	      m_hopOpState(stdexec::connect(stdexec::schedule(scheduler),
+	                                    hop_receiver{this})),
+	      m_childOpState(stdexec::connect(std::forward<Sender>(sender),
+	                                      child_receiver{this})) {}
+
+	qthread_continues_on_op_state(const qthread_continues_on_op_state&) = delete;
+	qthread_continues_on_op_state(qthread_continues_on_op_state&&)      = delete;
+
+	void start() noexcept { stdexec::start(m_childOpState); }
+
+private:
+	template <class Tag, class... Args>
+	void arrive(Tag, Args&&... args) noexcept {
+		if (m_inlineOn && try_run_inline(*m_inlineOn, [&]() noexcept {
+			    Tag{}(std::move(m_recv), std::forward<Args>(args)...);
+		    })) {
+			return;
+		}
+		try {
+			m_completion.template emplace<std::tuple<Tag, std::decay_t<Args>...>>(
+			    Tag{}, std::forward<Args>(args)...);
+		} catch (...) {
+			stdexec::set_error(std::move(m_recv), std::current_exception());
+			return;
+		}
+		stdexec::start(m_hopOpState);
+	}
+
+	void deliver() noexcept {
+		std::visit(
+		    [&](auto& completion) {
+			    if constexpr (!std::is_same_v<std::decay_t<decltype(completion)>,
+			                                  std::monostate>) {
+				    std::apply(
+				        [&](auto tag, auto&... args) {
+					        tag(std::move(m_recv), std::move(args)...);
+				        },
+				        completion);
+			    }
+		    },
+		    m_completion);
+	}
+
+	using hop_op_state = stdexec::connect_result_t<
+	    stdexec::schedule_result_t<const Scheduler&>, hop_receiver>;
+	using child_op_state = stdexec::connect_result_t<Sender, child_receiver>;
+
+	using completion_t =
+	    completions_variant_t<Sender, stdexec::env_of_t<Recv>>;
+
+	Recv                                  m_recv;
+	const std::optional<QThreadScheduler> m_inlineOn;
+	completion_t                          m_completion;
+	hop_op_state                          m_hopOpState;
+	child_op_state                        m_childOpState;
+};
+
+template <class... Ts>
+using no_value_signature = stdexec::completion_signatures<>;
+
+template <class Scheduler, class Sender>
+struct qthread_continues_on_sender {
+	using __id = qthread_continues_on_sender;
+	using __t  = qthread_continues_on_sender;
+
+	using sender_concept = stdexec::sender_t;
+
+	// Errors of the hop, besides its own stop
+	template <class Env>
+	using hop_signatures_t = stdexec::transform_completion_signatures_of<
+	    stdexec::schedule_result_t<const Scheduler&>, Env,
+	    stdexec::completion_signatures<stdexec::set_error_t(std::exception_ptr),
+	                                   stdexec::set_stopped_t()>,
+	    no_value_signature, decayed_error_signature>;
+
+	// Values and errors are decayed, they may be kept until the hop
+	template <class Env>
+	using completion_signatures_t = stdexec::transform_completion_signatures_of<
+	    Sender, Env, hop_signatures_t<Env>, decayed_value_signature,
+	    decayed_error_signature>;
+
+	// inlineOn is the QThreadScheduler on whose thread the completion of the
+	// predecessor is passed on inline, if any
+	qthread_continues_on_sender(Scheduler                       scheduler,
+	                            std::optional<QThreadScheduler> inlineOn,
+	                            Sender                          sender)
+	    : m_scheduler(std::move(scheduler)), m_inlineOn(inlineOn),
+	      m_sender(std::move(sender)) {}
+
+	template <class Env>
+	auto get_completion_signatures(Env&& /*env*/) const
+	    -> completion_signatures_t<std::decay_t<Env>> {
+		return {};
+	}
+
+	[[nodiscard]] auto get_env() const noexcept {
+		if constexpr (std::same_as<Scheduler, QThreadScheduler>) {
+			return stdexec::get_env(m_scheduler.schedule());
+		} else {
+			return stdexec::prop{
+			    stdexec::get_completion_scheduler<stdexec::set_value_t>,
+			    m_scheduler};
+		}
+	}
+
+	template <stdexec::receiver Recv>
+	auto connect(Recv recv) && -> qthread_continues_on_op_state<Scheduler, Sender,
+	                                                            Recv> {
+		return {m_scheduler, m_inlineOn, std::move(m_sender), std::move(recv)};
+	}
+
+	template <stdexec::receiver Recv>
+	auto connect(Recv recv) const& -> qthread_continues_on_op_state<
+	                                  Scheduler, const Sender&, Recv> {
+		return {m_scheduler, m_inlineOn, m_sender, std::move(recv)};
+	}
+
+private:
+	Scheduler                       m_scheduler;
+	std::optional<QThreadScheduler> m_inlineOn;
+	Sender                          m_sender;
+};
+
+// Environment of the work started by starts_on
+template <class Env>
+using starts_on_env =
+    stdexec::env<stdexec::prop<stdexec::get_scheduler_t, QThreadScheduler>,
+                 Env>;
+
+// Operation state of starts_on a QThreadScheduler, the work is started inline
+// when starts_on is started on the thread of the scheduler
+template <class Sender, class Recv>
+struct qthread_starts_on_op_state {
+	struct child_receiver {
+		using receiver_concept = stdexec::receiver_t;
+
+		template <class... Args>
+		void set_value(Args&&... args) noexcept {
+			stdexec::set_value(std::move(m_opState->m_recv),
+			                   std::forward<Args>(args)...);
+		}
+
+		template <class Error>
+		void set_error(Error&& error) noexcept {
+			stdexec::set_error(std::move(m_opState->m_recv),
+			                   std::forward<Error>(error));
+		}
+
+		void set_stopped() noexcept {
+			stdexec::set_stopped(std::move(m_opState->m_recv));
+		}
+
+		[[nodiscard]] auto get_env() const noexcept
+		    -> starts_on_env<stdexec::env_of_t<Recv>> {
+			return {stdexec::prop{stdexec::get_scheduler, m_opState->m_scheduler},
+			        stdexec::get_env(m_opState->m_recv)};
+		}
+
+		qthread_starts_on_op_state* m_opState;
 	};
 
-	auto schedule_after(std::chrono::system_clock::duration deadline) const
-	    -> delay_sender {
-		return delay_sender{m_thread, deadline};
+	struct hop_receiver {
+		using receiver_concept = stdexec::receiver_t;
+
+		void set_value() noexcept { stdexec::start(m_opState->m_childOpState); }
+
+		void set_stopped() noexcept {
+			stdexec::set_stopped(std::move(m_opState->m_recv));
+		}
+
+		[[nodiscard]] auto get_env() const noexcept -> stdexec::env_of_t<Recv> {
+			return stdexec::get_env(m_opState->m_recv);
+		}
+
+		qthread_starts_on_op_state* m_opState;
 	};
 
-	auto operator==(const QThreadScheduler&) const noexcept -> bool = default;
+	qthread_starts_on_op_state(const QThreadScheduler& scheduler,
+	                           Sender&& sender, Recv recv)
+	    : m_recv(std::move(recv)), m_scheduler(scheduler),
+	      m_hopOpState(stdexec::connect(stdexec::schedule(scheduler),
+	                                    hop_receiver{this})),
+	      m_childOpState(stdexec::connect(std::forward<Sender>(sender),
+	                                      child_receiver{this})) {}
+
+	qthread_starts_on_op_state(const qthread_starts_on_op_state&) = delete;
+	qthread_starts_on_op_state(qthread_starts_on_op_state&&)      = delete;
+
+	void start() noexcept {
+		if (!try_run_inline(m_scheduler,
+		                    [this]() noexcept { stdexec::start(m_childOpState); })) {
+			stdexec::start(m_hopOpState);
+		}
+	}
+
+private:
+	using hop_op_state =
+	    stdexec::connect_result_t<QThreadScheduler::sender, hop_receiver>;
+	using child_op_state = stdexec::connect_result_t<Sender, child_receiver>;
+
+	Recv                   m_recv;
+	const QThreadScheduler m_scheduler;
+	hop_op_state           m_hopOpState;
+	child_op_state         m_childOpState;
+};
+
+template <class Sender>
+struct qthread_starts_on_sender {
+	using __id = qthread_starts_on_sender;
+	using __t  = qthread_starts_on_sender;
+
+	using sender_concept = stdexec::sender_t;
+
+	template <class Env>
+	using completion_signatures_t = stdexec::transform_completion_signatures_of<
+	    Sender, starts_on_env<Env>,
+	    stdexec::completion_signatures<stdexec::set_stopped_t()>>;
+
+	qthread_starts_on_sender(QThreadScheduler scheduler, Sender sender)
+	    : m_scheduler(scheduler), m_sender(std::move(sender)) {}
+
+	template <class Env>
+	auto get_completion_signatures(Env&& /*env*/) const
+	    -> completion_signatures_t<std::decay_t<Env>> {
+		return {};
+	}
+
+	[[nodiscard]] auto get_env() const noexcept -> stdexec::env_of_t<Sender> {
+		return stdexec::get_env(m_sender);
+	}
+
+	template <stdexec::receiver Recv>
+	auto connect(Recv recv) && -> qthread_starts_on_op_state<Sender, Recv> {
+		return {m_scheduler, std::move(m_sender), std::move(recv)};
+	}
+
+	template <stdexec::receiver Recv>
+	auto connect(Recv recv) const& -> qthread_starts_on_op_state<const Sender&,
+	                                                            Recv> {
+		return {m_scheduler, m_sender, std::move(recv)};
+	}
 
 private:
-	QThread* const m_thread;
+	QThreadScheduler m_scheduler;
+	Sender           m_sender;
 };
+} // namespace detail
 } // namespace stdexecutils::qt
 #endif
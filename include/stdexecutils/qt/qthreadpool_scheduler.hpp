@@ -1,26 +1,64 @@
 #pragma once
+#include <stdexecutils/qt/detail/metrics_recorder.hpp>
+#include <stdexecutils/qt/detail/threadpool_timer_service.hpp>
+#include <stdexecutils/qt/queries.hpp>
+#include <stdexecutils/qt/tracing.hpp>
+
 #include <QThreadPool>
 #include <stdexec/execution.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
 namespace stdexecutils::qt {
 namespace detail {
 
 struct threadpool_scheduler;
 
 struct threadpool_env {
-	explicit threadpool_env(QThreadPool* pool) noexcept : m_pool(pool) {}
+	threadpool_env(QThreadPool* pool, int priority,
+	               metrics_recorder* metrics) noexcept
+	    : m_pool(pool), m_priority(priority), m_metrics(metrics) {}
 	template <class CompletionTag>
 	auto query(stdexec::get_completion_scheduler_t<CompletionTag>) const noexcept
 	    -> threadpool_scheduler;
 
+	auto query(get_priority_t) const noexcept -> int { return m_priority; }
+
 private:
-	QThreadPool* const m_pool;
+	QThreadPool* const      m_pool;
+	const int               m_priority;
+	metrics_recorder* const m_metrics;
 };
 
+// The operation state is the QRunnable that is submitted to the pool, so
+// scheduling does not allocate. It is not auto-deleted, its lifetime is owned
+// by whoever connected the sender.
+//
+// A stop request takes the runnable back out of the pool queue, so cancelled
+// work does not occupy a pool slot.
 template <stdexec::receiver Recv>
-struct threadpool_op_state {
-	explicit threadpool_op_state(Recv&& recv, QThreadPool* pool) noexcept
-	    : m_pool(pool), m_recv(std::move(recv)) {}
+struct threadpool_op_state : private QRunnable {
+	threadpool_op_state(Recv&& recv, QThreadPool* pool, int priority,
+	                    metrics_recorder* metrics) noexcept
+	    : m_recv(std::move(recv)), m_pool(pool), m_priority(priority),
+	      m_metrics(metrics) {
+		setAutoDelete(false);
+	}
+
+	threadpool_op_state(const threadpool_op_state&) = delete;
+	threadpool_op_state(threadpool_op_state&&)      = delete;
+
+	~threadpool_op_state() override = default;
 
 	void start() noexcept {
 		stdexec::stoppable_token auto stop_token =
@@ -29,13 +67,60 @@ struct threadpool_op_state {
 			stdexec::set_stopped(std::move(m_recv));
 			return;
 		}
+		if (stop_token.stop_possible()) {
+			// Registered before submitting, the runnable may complete right away
+			m_stoppedCallback.emplace(std::move(stop_token),
+			                          stop_callback_fun{*this});
+			if (stdexec::get_stop_token(stdexec::get_env(m_recv))
+			        .stop_requested()) {
+				m_stoppedCallback.reset();
+				stdexec::set_stopped(std::move(m_recv));
+				return;
+			}
+		}
 
-		m_pool->start([this]() { stdexec::set_value(std::move(m_recv)); });
+		trace_enqueue(this, stdexec::get_env(m_recv));
+		m_enqueuedAt = m_metrics->enqueued();
+		m_pool->start(this, m_priority);
 	}
 
 private:
-	Recv               m_recv;
-	QThreadPool* const m_pool;
+	struct stop_callback_fun {
+		threadpool_op_state& op_state;
+
+		void operator()() noexcept {
+			// Fails if the runnable is not queued (anymore), run() then observes the
+			// stop request itself
+			if (op_state.m_pool->tryTake(&op_state)) {
+				const trace_run trace(&op_state);
+				op_state.m_metrics->dequeued(op_state.m_enqueuedAt);
+				op_state.m_stoppedCallback.reset();
+				stdexec::set_stopped(std::move(op_state.m_recv));
+			}
+		}
+	};
+
+	void run() override {
+		const trace_run trace(this);
+		m_metrics->started(m_enqueuedAt);
+		// Waits for a concurrently running stop callback
+		m_stoppedCallback.reset();
+		if (stdexec::get_stop_token(stdexec::get_env(m_recv)).stop_requested()) {
+			stdexec::set_stopped(std::move(m_recv));
+			return;
+		}
+		stdexec::set_value(std::move(m_recv));
+	}
+
+	using stop_callback = stdexec::stop_callback_for_t<
+	    stdexec::stop_token_of_t<stdexec::env_of_t<Recv>>, stop_callback_fun>;
+
+	Recv                                m_recv;
+	QThreadPool* const                  m_pool;
+	const int                           m_priority;
+	metrics_recorder* const             m_metrics;
+	metrics_recorder::clock::time_point m_enqueuedAt;
+	std::optional<stop_callback>        m_stoppedCallback;
 };
 
 struct threadpool_sender {
@@ -47,44 +132,525 @@ struct threadpool_sender {
 	    stdexec::completion_signatures<stdexec::set_value_t(),
 	                                   stdexec::set_stopped_t()>;
 
-	explicit threadpool_sender(QThreadPool* pool) noexcept : m_pool(pool) {}
+	threadpool_sender(QThreadPool* pool, int priority,
+	                  metrics_recorder* metrics) noexcept
+	    : m_pool(pool), m_priority(priority), m_metrics(metrics) {}
+
+	stdexec::queryable auto get_env() const noexcept {
+		return threadpool_env(m_pool, m_priority, m_metrics);
+	}
+
+	template <stdexec::receiver Recv>
+	stdexec::operation_state auto connect(Recv&& recv) const noexcept {
+		return threadpool_op_state<Recv>(std::move(recv), m_pool, m_priority,
+		                                 m_metrics);
+	}
+
+private:
+	QThreadPool* const      m_pool;
+	const int               m_priority;
+	metrics_recorder* const m_metrics;
+};
+
+// Operation state of schedule_at and schedule_after. It is a node of the shared
+// timer service until the deadline expires, and then the runnable that is
+// submitted to the pool. A stop request removes it from whichever of the two
+// currently holds it, so cancelled timeouts leave nothing queued on the pool.
+template <stdexec::receiver Recv>
+struct threadpool_timeout_op_state : private QRunnable, private timer_node {
+	using clock = threadpool_timer_service::clock;
+
+	threadpool_timeout_op_state(Recv&& recv, QThreadPool* pool, int priority,
+	                            metrics_recorder* metrics,
+	                            clock::time_point deadline) noexcept
+	    : timer_node(&threadpool_timeout_op_state::fire),
+	      m_recv(std::move(recv)), m_pool(pool), m_priority(priority),
+	      m_metrics(metrics), m_deadline(deadline) {
+		setAutoDelete(false);
+	}
+
+	threadpool_timeout_op_state(const threadpool_timeout_op_state&) = delete;
+	threadpool_timeout_op_state(threadpool_timeout_op_state&&)      = delete;
+
+	~threadpool_timeout_op_state() override = default;
+
+	void start() noexcept {
+		stdexec::stoppable_token auto stop_token =
+		    stdexec::get_stop_token(stdexec::get_env(m_recv));
+		if (stop_token.stop_requested()) {
+			stdexec::set_stopped(std::move(m_recv));
+			return;
+		}
+		if (stop_token.stop_possible()) {
+			// Registered before arming, the timer may complete right away
+			m_stoppedCallback.emplace(std::move(stop_token),
+			                          stop_callback_fun{*this});
+			if (stdexec::get_stop_token(stdexec::get_env(m_recv))
+			        .stop_requested()) {
+				m_stoppedCallback.reset();
+				stdexec::set_stopped(std::move(m_recv));
+				return;
+			}
+		}
+
+		trace_enqueue(this, stdexec::get_env(m_recv));
+		threadpool_timer_service::instance().add(this, m_deadline);
+	}
+
+private:
+	struct stop_callback_fun {
+		threadpool_timeout_op_state& op_state;
+
+		void operator()() noexcept {
+			// Fails for both if the runnable already left the pool queue, run()
+			// then observes the stop request itself
+			const bool armed = threadpool_timer_service::instance().remove(&op_state);
+			if (armed || op_state.m_pool->tryTake(&op_state)) {
+				const trace_run trace(&op_state);
+				if (!armed) {
+					op_state.m_metrics->dequeued(op_state.m_enqueuedAt);
+				}
+				op_state.m_stoppedCallback.reset();
+				stdexec::set_stopped(std::move(op_state.m_recv));
+			}
+		}
+	};
+
+	// Runs on the timer service thread, with the service locked
+	static void fire(timer_node* node, bool stopped) noexcept {
+		auto& self = *static_cast<threadpool_timeout_op_state*>(node);
+		if (stopped) {
+			// The service shuts down
+			const trace_run trace(&self);
+			self.m_stoppedCallback.reset();
+			stdexec::set_stopped(std::move(self.m_recv));
+			return;
+		}
+		self.m_enqueuedAt = self.m_metrics->enqueued();
+		self.m_pool->start(&self, self.m_priority);
+	}
+
+	void run() override {
+		const trace_run trace(this);
+		m_metrics->started(m_enqueuedAt);
+		// Waits for a concurrently running stop callback
+		m_stoppedCallback.reset();
+		if (stdexec::get_stop_token(stdexec::get_env(m_recv)).stop_requested()) {
+			stdexec::set_stopped(std::move(m_recv));
+			return;
+		}
+		stdexec::set_value(std::move(m_recv));
+	}
+
+	using stop_callback = stdexec::stop_callback_for_t<
+	    stdexec::stop_token_of_t<stdexec::env_of_t<Recv>>, stop_callback_fun>;
+
+	Recv                         m_recv;
+	QThreadPool* const           m_pool;
+	const int                    m_priority;
+	metrics_recorder* const      m_metrics;
+	const clock::time_point      m_deadline;
+	clock::time_point            m_enqueuedAt;
+	std::optional<stop_callback> m_stoppedCallback;
+};
+
+struct threadpool_timeout_sender {
+	using __id = threadpool_timeout_sender;
+	using __t  = threadpool_timeout_sender;
+
+	using sender_concept = stdexec::sender_t;
+	using completion_signatures =
+	    stdexec::completion_signatures<stdexec::set_value_t(),
+	                                   stdexec::set_stopped_t()>;
+
+	threadpool_timeout_sender(
+	    QThreadPool* pool, int priority, metrics_recorder* metrics,
+	    threadpool_timer_service::clock::time_point deadline) noexcept
+	    : m_pool(pool), m_priority(priority), m_metrics(metrics),
+	      m_deadline(deadline) {}
 
 	stdexec::queryable auto get_env() const noexcept {
-		return threadpool_env(m_pool);
+		return threadpool_env(m_pool, m_priority, m_metrics);
 	}
 
 	template <stdexec::receiver Recv>
 	stdexec::operation_state auto connect(Recv&& recv) const noexcept {
-		return threadpool_op_state<Recv>(std::move(recv), m_pool);
+		return threadpool_timeout_op_state<Recv>(
+		    std::move(recv), m_pool, m_priority, m_metrics, m_deadline);
+	}
+
+private:
+	QThreadPool* const                                m_pool;
+	const int                                         m_priority;
+	metrics_recorder* const                           m_metrics;
+	const threadpool_timer_service::clock::time_point m_deadline;
+};
+
+template <class... Ts>
+using bulk_decayed_tuple = std::tuple<std::decay_t<Ts>...>;
+
+template <class... Ts>
+using bulk_values_variant = std::variant<std::monostate, Ts...>;
+
+// The values are kept in the operation state and sent on as decayed copies
+template <class... Ts>
+using bulk_value_signature =
+    stdexec::completion_signatures<stdexec::set_value_t(std::decay_t<Ts>...)>;
+
+// Operation state of stdexec::bulk on the QThreadPool scheduler. The values of
+// the predecessor are kept in the operation state, the index space is then
+// processed by up to maxThreadCount() runnables that grab chunks from a
+// shared counter. Chunks shrink as the remaining work shrinks, so busy pool
+// threads simply grab fewer of them. The last runnable to finish completes
+// the receiver.
+template <class Sender, std::integral Shape, class Fun, class Recv>
+struct bulk_op_state {
+	using values_t =
+	    stdexec::value_types_of_t<Sender, stdexec::env_of_t<Recv>,
+	                              bulk_decayed_tuple, bulk_values_variant>;
+
+	struct child_receiver {
+		using receiver_concept = stdexec::receiver_t;
+
+		template <class... Args>
+		void set_value(Args&&... args) noexcept {
+			m_opState->execute(std::forward<Args>(args)...);
+		}
+
+		template <class Error>
+		void set_error(Error&& error) noexcept {
+			stdexec::set_error(std::move(m_opState->m_recv),
+			                   std::forward<Error>(error));
+		}
+
+		void set_stopped() noexcept {
+			stdexec::set_stopped(std::move(m_opState->m_recv));
+		}
+
+		[[nodiscard]] auto get_env() const noexcept -> stdexec::env_of_t<Recv> {
+			return stdexec::get_env(m_opState->m_recv);
+		}
+
+		bulk_op_state* m_opState;
+	};
+
+	bulk_op_state(Sender&& sender, Shape shape, Fun fun, Recv recv,
+	              QThreadPool* pool, int priority)
+	    : m_recv(std::move(recv)), m_fun(std::move(fun)), m_shape(shape),
+	      m_pool(pool), m_priority(priority), m_workerCount(static_cast<std::size_t>(
+	                        std::max(pool->maxThreadCount(), 1))),
+	      m_workers(std::make_unique<worker[]>(m_workerCount - 1)),
+	      m_childOpState(stdexec::connect(std::forward<Sender>(sender),
+	                                      child_receiver{this})) {}
+
+	bulk_op_state(const bulk_op_state&) = delete;
+	bulk_op_state(bulk_op_state&&)      = delete;
+
+	void start() noexcept { stdexec::start(m_childOpState); }
+
+private:
+	struct worker : public QRunnable {
+		worker() noexcept { setAutoDelete(false); }
+
+		worker(const worker&) = delete;
+		worker(worker&&)      = delete;
+
+		~worker() override = default;
+
+		void run() override {
+			const trace_run trace(this);
+			m_opState->run_chunks();
+			m_opState->finish();
+		}
+
+		bulk_op_state* m_opState{nullptr};
+	};
+
+	template <class... Args>
+	void execute(Args&&... args) noexcept {
+		try {
+			m_values.template emplace<bulk_decayed_tuple<Args...>>(
+			    std::forward<Args>(args)...);
+		} catch (...) {
+			stdexec::set_error(std::move(m_recv), std::current_exception());
+			return;
+		}
+
+		// The calling thread is a pool thread as well, it processes chunks too
+		// and needs no runnable
+		const auto idleThreads =
+		    std::max(m_pool->maxThreadCount() - m_pool->activeThreadCount(), 0);
+		const auto workers =
+		    std::min({static_cast<std::size_t>(idleThreads) + 1, m_workerCount,
+		              static_cast<std::size_t>(std::max(m_shape, Shape{1}))});
+
+		m_pending.store(workers, std::memory_order_relaxed);
+		m_parallelism = workers;
+		for (std::size_t i = 0; i + 1 < workers; ++i) {
+			m_workers[i].m_opState = this;
+			trace_enqueue(&m_workers[i], stdexec::get_env(m_recv));
+			m_pool->start(&m_workers[i], m_priority);
+		}
+		const trace_run trace(this);
+		run_chunks();
+		finish();
+	}
+
+	void run_chunks() noexcept {
+		auto stop_token = stdexec::get_stop_token(stdexec::get_env(m_recv));
+		while (!m_failed.load(std::memory_order_relaxed) &&
+		       !stop_token.stop_requested()) {
+			const auto remaining =
+			    m_shape - std::min(m_next.load(std::memory_order_relaxed), m_shape);
+			const auto chunk = std::max(
+			    static_cast<Shape>(remaining /
+			                       static_cast<Shape>(4 * m_parallelism)),
+			    Shape{1});
+			const auto begin = m_next.fetch_add(chunk, std::memory_order_relaxed);
+			if (begin >= m_shape) {
+				return;
+			}
+			const auto end = std::min(static_cast<Shape>(begin + chunk), m_shape);
+			try {
+				std::visit(
+				    [&](auto& values) {
+					    if constexpr (!std::is_same_v<std::decay_t<decltype(values)>,
+					                                  std::monostate>) {
+						    std::apply(
+						        [&](auto&... args) {
+							        for (auto i = begin; i < end; ++i) {
+								        m_fun(i, args...);
+							        }
+						        },
+						        values);
+					    }
+				    },
+				    m_values);
+			} catch (...) {
+				if (!m_failed.exchange(true, std::memory_order_relaxed)) {
+					m_exception = std::current_exception();
+				}
+			}
+		}
+	}
+
+	// Single join point, the last runnable completes the receiver
+	void finish() noexcept {
+		if (m_pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+			return;
+		}
+		if (m_failed.load(std::memory_order_relaxed)) {
+			stdexec::set_error(std::move(m_recv), std::move(m_exception));
+			return;
+		}
+		if (stdexec::get_stop_token(stdexec::get_env(m_recv)).stop_requested()) {
+			stdexec::set_stopped(std::move(m_recv));
+			return;
+		}
+		std::visit(
+		    [&](auto& values) {
+			    if constexpr (!std::is_same_v<std::decay_t<decltype(values)>,
+			                                  std::monostate>) {
+				    std::apply(
+				        [&](auto&... args) {
+					        stdexec::set_value(std::move(m_recv), std::move(args)...);
+				        },
+				        values);
+			    }
+		    },
+		    m_values);
+	}
+
+	using child_op_state = stdexec::connect_result_t<Sender, child_receiver>;
+
+	Recv                      m_recv;
+	Fun                       m_fun;
+	const Shape               m_shape;
+	QThreadPool* const        m_pool;
+	const int                 m_priority;
+	const std::size_t         m_workerCount;
+	// One less than m_workerCount, the calling thread works as well
+	std::unique_ptr<worker[]> m_workers;
+	values_t                  m_values;
+	std::atomic<Shape>        m_next{0};
+	std::atomic<std::size_t>  m_pending{0};
+	std::size_t               m_parallelism{1};
+	std::atomic<bool>         m_failed{false};
+	std::exception_ptr        m_exception;
+	child_op_state            m_childOpState;
+};
+
+template <class Sender, std::integral Shape, class Fun>
+struct bulk_sender {
+	using __id = bulk_sender;
+	using __t  = bulk_sender;
+
+	using sender_concept = stdexec::sender_t;
+
+	template <class Env>
+	using completion_signatures_t = stdexec::transform_completion_signatures_of<
+	    Sender, Env,
+	    stdexec::completion_signatures<stdexec::set_error_t(std::exception_ptr),
+	                                   stdexec::set_stopped_t()>,
+	    bulk_value_signature>;
+
+	bulk_sender(QThreadPool* pool, int priority, Sender sender, Shape shape,
+	            Fun fun)
+	    : m_pool(pool), m_priority(priority), m_sender(std::move(sender)),
+	      m_shape(shape),
+	      m_fun(std::move(fun)) {}
+
+	template <class Env>
+	auto get_completion_signatures(Env&& /*env*/) const
+	    -> completion_signatures_t<std::decay_t<Env>> {
+		return {};
+	}
+
+	[[nodiscard]] auto get_env() const noexcept -> stdexec::env_of_t<Sender> {
+		return stdexec::get_env(m_sender);
+	}
+
+	template <stdexec::receiver Recv>
+	auto connect(Recv recv) && -> bulk_op_state<Sender, Shape, Fun, Recv> {
+		return {std::move(m_sender), m_shape, std::move(m_fun), std::move(recv),
+		        m_pool, m_priority};
+	}
+
+	template <stdexec::receiver Recv>
+	auto connect(Recv recv) const& -> bulk_op_state<const Sender&, Shape, Fun,
+	                                               Recv> {
+		return {m_sender, m_shape, m_fun, std::move(recv), m_pool, m_priority};
 	}
 
 private:
-	QThreadPool* const m_pool;
+	QThreadPool* m_pool;
+	int          m_priority;
+	Sender       m_sender;
+	Shape        m_shape;
+	Fun          m_fun;
+};
+
+// Replaces the default sequential stdexec::bulk with bulk_sender when the
+// predecessor completes on, or the work is started on, the QThreadPool
+// scheduler
+struct threadpool_domain : stdexec::default_domain {
+	struct transform_bulk {
+		template <class Data, class Sender>
+		auto operator()(stdexec::bulk_t, Data&& data, Sender&& sender) const {
+			auto [shape, fun] = std::forward<Data>(data);
+			return bulk_sender<std::decay_t<Sender>, decltype(shape),
+			                   decltype(fun)>{m_pool, m_priority,
+			                                  std::forward<Sender>(sender), shape,
+			                                  std::move(fun)};
+		}
+
+		QThreadPool* m_pool;
+		int          m_priority;
+	};
+
+	// Eager customization, the predecessor completes on the pool
+	template <stdexec::sender_expr_for<stdexec::bulk_t> Sender>
+	    requires stdexec::__completes_on<Sender, threadpool_scheduler>
+	auto transform_sender(Sender&& sender) const noexcept {
+		auto scheduler = stdexec::get_completion_scheduler<stdexec::set_value_t>(
+		    stdexec::get_env(sender));
+		return stdexec::__sexpr_apply(std::forward<Sender>(sender),
+		                              transform_bulk{scheduler.pool(),
+		                                             scheduler.priority()});
+	}
+
+	// Lazy customization. The completion scheduler of the predecessor is used
+	// if it is the pool, else the scheduler the work is started on. Other bulk
+	// work stays with the default implementation.
+	template <stdexec::sender_expr_for<stdexec::bulk_t> Sender, class Env>
+	auto transform_sender(Sender&& sender, const Env& env) const noexcept {
+		if constexpr (stdexec::__completes_on<Sender, threadpool_scheduler>) {
+			return transform_sender(std::forward<Sender>(sender));
+		} else if constexpr (stdexec::__starts_on<Sender, threadpool_scheduler,
+		                                          Env>) {
+			auto scheduler = stdexec::get_scheduler(env);
+			return stdexec::__sexpr_apply(std::forward<Sender>(sender),
+			                              transform_bulk{scheduler.pool(),
+			                                             scheduler.priority()});
+		} else {
+			return stdexec::default_domain{}.transform_sender(
+			    std::forward<Sender>(sender), env);
+		}
+	}
 };
 
 struct threadpool_scheduler {
 	using __id = threadpool_scheduler;
 	using __t  = threadpool_scheduler;
 
-	explicit threadpool_scheduler(QThreadPool* pool) noexcept : m_pool(pool) {}
-	stdexec::sender auto schedule() noexcept { return threadpool_sender(m_pool); }
+	// Work of schedulers with a higher priority is run first when the pool is
+	// saturated, see QThreadPool::start
+	explicit threadpool_scheduler(QThreadPool* pool, int priority = 0)
+	    : threadpool_scheduler(pool, priority,
+	                           metrics_recorder::for_pool(pool)) {}
+
+	threadpool_scheduler(QThreadPool* pool, int priority,
+	                     metrics_recorder* metrics) noexcept
+	    : m_pool(pool), m_priority(priority), m_metrics(metrics) {}
+
+	stdexec::sender auto schedule() noexcept {
+		return threadpool_sender(m_pool, m_priority, m_metrics);
+	}
+
+	[[nodiscard]] auto now() const noexcept
+	    -> threadpool_timer_service::clock::time_point {
+		return threadpool_timer_service::instance().now();
+	}
+
+	auto schedule_at(threadpool_timer_service::clock::time_point deadline)
+	    const noexcept -> threadpool_timeout_sender {
+		return {m_pool, m_priority, m_metrics, deadline};
+	}
+
+	auto schedule_after(threadpool_timer_service::clock::duration delay)
+	    const noexcept -> threadpool_timeout_sender {
+		return {m_pool, m_priority, m_metrics, now() + delay};
+	}
+
+	auto query(get_priority_t) const noexcept -> int { return m_priority; }
+
+	[[nodiscard]] auto query(stdexec::get_domain_t) const noexcept
+	    -> threadpool_domain {
+		return {};
+	}
+
+	[[nodiscard]] auto pool() const noexcept -> QThreadPool* { return m_pool; }
+
+	[[nodiscard]] auto priority() const noexcept -> int { return m_priority; }
+
+	// Starts recording the metrics of the pool, for all its schedulers. Work
+	// queued before is not counted.
+	void enable_metrics() const noexcept { m_metrics->enable(); }
+
+	// Metrics of the pool, they are shared by all schedulers of the pool. Bulk
+	// work is not counted. They stay empty unless enable_metrics() was called.
+	[[nodiscard]] auto metrics() const noexcept -> scheduler_metrics {
+		return m_metrics->snapshot();
+	}
 
 	auto operator==(const threadpool_scheduler&) const noexcept -> bool = default;
 
 private:
-	QThreadPool* const m_pool;
+	QThreadPool* const      m_pool;
+	const int               m_priority;
+	metrics_recorder* const m_metrics;
 };
 
 template <class CompletionTag>
 auto threadpool_env::query(stdexec::get_completion_scheduler_t<CompletionTag>)
     const noexcept -> threadpool_scheduler {
-	return threadpool_scheduler(m_pool);
+	return threadpool_scheduler(m_pool, m_priority, m_metrics);
 }
 
 } // namespace detail
 
 stdexec::scheduler auto inline qthread_scheduler(
-    QThreadPool* pool = QThreadPool::globalInstance()) {
-	return detail::threadpool_scheduler(pool);
+    QThreadPool* pool = QThreadPool::globalInstance(), int priority = 0) {
+	return detail::threadpool_scheduler(pool, priority);
 }
 } // namespace stdexecutils::qt
@@ -0,0 +1,55 @@
+#ifndef STDEXEC_UTILS_QUERIES_HPP
+#define STDEXEC_UTILS_QUERIES_HPP
+
+#ifndef Q_MOC_RUN
+#include <stdexec/execution.hpp>
+#endif
+
+#include <utility>
+
+namespace stdexecutils::qt {
+
+// Queries the scheduling priority of a scheduler or of the environment of a
+// sender. QThreadScheduler reports its Qt::EventPriority, the QThreadPool
+// scheduler the priority its runnables are submitted with.
+struct get_priority_t {
+	template <class Env>
+	    requires requires(const Env& env) {
+		    env.query(std::declval<const get_priority_t&>());
+	    }
+	auto operator()(const Env& env) const noexcept -> int {
+		return static_cast<int>(env.query(*this));
+	}
+
+	static constexpr auto query(stdexec::forwarding_query_t) noexcept -> bool {
+		return true;
+	}
+};
+
+inline constexpr get_priority_t get_priority{};
+
+// Queries the label that tracing records for the operations started with an
+// environment, see tracing.hpp. Environments without one yield nullptr. The
+// string is not copied, it has to outlive the trace, like a string literal.
+struct get_trace_label_t {
+	template <class Env>
+	auto operator()(const Env& env) const noexcept -> const char* {
+		if constexpr (requires {
+			              env.query(std::declval<const get_trace_label_t&>());
+		              }) {
+			return env.query(*this);
+		} else {
+			return nullptr;
+		}
+	}
+
+	static constexpr auto query(stdexec::forwarding_query_t) noexcept -> bool {
+		return true;
+	}
+};
+
+inline constexpr get_trace_label_t get_trace_label{};
+
+} // namespace stdexecutils::qt
+
+#endif // STDEXEC_UTILS_QUERIES_HPP
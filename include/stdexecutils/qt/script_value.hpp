@@ -0,0 +1,415 @@
+#ifndef STDEXEC_UTILS_SCRIPT_VALUE_HPP
+#define STDEXEC_UTILS_SCRIPT_VALUE_HPP
+
+#ifndef Q_MOC_RUN
+#include <stdexec/execution.hpp>
+#endif
+
+#include <QByteArray>
+#include <QJSEngine>
+#include <QJSValue>
+#include <QPointer>
+#include <QString>
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace stdexecutils::qt {
+
+// Member of an aggregate that is listed in script_fields
+template <class Class, class Member>
+struct script_field {
+	const char* name;
+	Member Class::*member;
+};
+
+// Names the members of an aggregate, to_script_value then converts it into a
+// JS object with these properties instead of an array:
+//
+//   template <>
+//   struct stdexecutils::qt::script_fields<Point> {
+//   	static constexpr auto value = std::tuple{script_field{"x", &Point::x},
+//   	                                         script_field{"y", &Point::y}};
+//   };
+template <class T>
+struct script_fields;
+
+struct to_script_value_t;
+
+namespace detail {
+
+// Name of the JS typed array for an element type, nullptr if there is none
+template <class T>
+consteval auto typedArrayName() -> const char* {
+	if constexpr (std::is_same_v<T, float>) {
+		return "Float32Array";
+	} else if constexpr (std::is_same_v<T, double>) {
+		return "Float64Array";
+	} else if constexpr (std::is_same_v<T, std::int8_t>) {
+		return "Int8Array";
+	} else if constexpr (std::is_same_v<T, std::uint8_t>) {
+		return "Uint8Array";
+	} else if constexpr (std::is_same_v<T, std::int16_t>) {
+		return "Int16Array";
+	} else if constexpr (std::is_same_v<T, std::uint16_t>) {
+		return "Uint16Array";
+	} else if constexpr (std::is_same_v<T, std::int32_t>) {
+		return "Int32Array";
+	} else if constexpr (std::is_same_v<T, std::uint32_t>) {
+		return "Uint32Array";
+	} else {
+		return nullptr;
+	}
+}
+
+template <class T>
+concept typed_array_element = (typedArrayName<T>() != nullptr);
+
+// Constructor of the typed array for T. Looking it up by name is costly, the
+// one of the engine last used on the thread is kept, engines are only used on
+// their own thread.
+template <typed_array_element T>
+auto typedArrayConstructor(QJSEngine* const jsEngine) -> QJSValue {
+	thread_local QPointer<QJSEngine> engine;
+	thread_local QJSValue            constructor;
+	if (engine != jsEngine) {
+		constructor = jsEngine->globalObject().property(
+		    QString::fromLatin1(typedArrayName<T>()));
+		engine = jsEngine;
+	}
+	return constructor;
+}
+
+template <class T>
+concept string_like = std::convertible_to<const T&, std::string_view> &&
+                      !std::is_pointer_v<std::decay_t<T>>;
+
+template <class T>
+concept script_key = string_like<T> || std::same_as<T, QString> ||
+                     std::integral<T>;
+
+template <class T>
+concept pair_like = requires {
+	requires std::tuple_size<T>::value == 2;
+};
+
+// Qt maps, like QVariantMap and QJsonObject, iterate over the mapped values,
+// their iterators have key() and value()
+template <class T>
+concept qt_map = requires(const T& map) {
+	map.constBegin().key();
+	map.constBegin().value();
+	map.constBegin() != map.constEnd();
+};
+
+template <class T>
+concept map_like =
+    std::ranges::input_range<T> &&
+    requires {
+	    typename T::key_type;
+	    typename T::mapped_type;
+    } && script_key<typename T::key_type> &&
+    (qt_map<T> || pair_like<std::ranges::range_value_t<T>>);
+
+template <class T>
+concept typed_array_range =
+    std::ranges::contiguous_range<T> && std::ranges::sized_range<T> &&
+    typed_array_element<std::remove_cv_t<std::ranges::range_value_t<T>>>;
+
+// Raw bytes, they become a plain ArrayBuffer
+template <class T>
+concept byte_range =
+    std::ranges::contiguous_range<T> && std::ranges::sized_range<T> &&
+    (std::same_as<std::remove_cv_t<std::ranges::range_value_t<T>>, char> ||
+     std::same_as<std::remove_cv_t<std::ranges::range_value_t<T>>, std::byte>);
+
+template <class T>
+concept optional_like = requires { typename T::value_type; } &&
+                        std::same_as<T, std::optional<typename T::value_type>>;
+
+template <class T>
+concept tuple_like = requires { std::tuple_size<T>::value; };
+
+template <class T>
+concept has_script_fields = requires { script_fields<T>::value; };
+
+// Converts to any type, used to count the members of an aggregate
+struct any_member {
+	template <class T>
+	operator T() const; // NOLINT(google-explicit-constructor)
+};
+
+template <class T, std::size_t... I>
+consteval auto brace_constructible(std::index_sequence<I...> /*unused*/)
+    -> bool {
+	return requires { T{(static_cast<void>(I), any_member{})...}; };
+}
+
+inline constexpr std::size_t max_aggregate_members = 8;
+
+// Number of members of an aggregate, array members are miscounted
+template <class T, std::size_t N = 0>
+consteval auto aggregate_members() -> std::size_t {
+	if constexpr (N < max_aggregate_members &&
+	              brace_constructible<T>(std::make_index_sequence<N + 1>{})) {
+		return aggregate_members<T, N + 1>();
+	} else {
+		return N;
+	}
+}
+
+template <class T>
+auto tie_aggregate(T& value) {
+	constexpr auto count = aggregate_members<std::remove_const_t<T>>();
+	static_assert(count < max_aggregate_members,
+	              "aggregate has too many members, specialize script_fields");
+	if constexpr (count == 0) {
+		return std::tie();
+	} else if constexpr (count == 1) {
+		auto& [m0] = value;
+		return std::tie(m0);
+	} else if constexpr (count == 2) {
+		auto& [m0, m1] = value;
+		return std::tie(m0, m1);
+	} else if constexpr (count == 3) {
+		auto& [m0, m1, m2] = value;
+		return std::tie(m0, m1, m2);
+	} else if constexpr (count == 4) {
+		auto& [m0, m1, m2, m3] = value;
+		return std::tie(m0, m1, m2, m3);
+	} else if constexpr (count == 5) {
+		auto& [m0, m1, m2, m3, m4] = value;
+		return std::tie(m0, m1, m2, m3, m4);
+	} else if constexpr (count == 6) {
+		auto& [m0, m1, m2, m3, m4, m5] = value;
+		return std::tie(m0, m1, m2, m3, m4, m5);
+	} else {
+		auto& [m0, m1, m2, m3, m4, m5, m6] = value;
+		return std::tie(m0, m1, m2, m3, m4, m5, m6);
+	}
+}
+
+// Property names of script_fields<T>, created once per type
+template <has_script_fields T>
+auto script_field_names() -> const auto& {
+	static const auto names = std::apply(
+	    [](const auto&... fields) {
+		    return std::array<QString, sizeof...(fields)>{
+		        QString::fromUtf8(fields.name)...};
+	    },
+	    script_fields<T>::value);
+	return names;
+}
+
+template <script_key Key>
+auto script_key_name(const Key& key) -> QString {
+	if constexpr (std::same_as<Key, QString>) {
+		return key;
+	} else if constexpr (std::integral<Key>) {
+		return QString::number(key);
+	} else {
+		const std::string_view view(key);
+		return QString::fromUtf8(view.data(), static_cast<qsizetype>(view.size()));
+	}
+}
+} // namespace detail
+
+// Converts a C++ value into a JS value of the given engine.
+//
+// Types customize the conversion with a tag_invoke overload found by ADL:
+//
+//   friend auto tag_invoke(stdexecutils::qt::to_script_value_t,
+//                          QJSEngine* jsEngine, const Point& point) -> QJSValue;
+//
+// Without one strings, numbers, QByteArray (ArrayBuffer), contiguous ranges of
+// numbers (typed arrays), std::optional, std::variant, maps (objects), other
+// ranges and tuples (arrays) and aggregates are converted directly with
+// newObject and newArray. Aggregates become arrays of their members, or
+// objects if script_fields names them. Everything else goes through
+// QJSEngine::toScriptValue.
+struct to_script_value_t {
+	template <class T>
+	auto operator()(QJSEngine* const jsEngine, T&& value) const -> QJSValue {
+		using type = std::remove_cvref_t<T>;
+		if constexpr (stdexec::tag_invocable<to_script_value_t, QJSEngine*, T>) {
+			return stdexec::tag_invoke(*this, jsEngine, std::forward<T>(value));
+		} else if constexpr (std::same_as<type, QJSValue>) {
+			return std::forward<T>(value);
+		} else if constexpr (std::same_as<type, QString>) {
+			return QJSValue(std::forward<T>(value));
+		} else if constexpr (std::same_as<std::decay_t<T>, const char*> ||
+		                     std::same_as<std::decay_t<T>, char*>) {
+			if (value == nullptr) {
+				return QJSValue::NullValue;
+			}
+			return QJSValue(QString::fromUtf8(value));
+		} else if constexpr (detail::string_like<type>) {
+			const std::string_view view(value);
+			return QJSValue(
+			    QString::fromUtf8(view.data(), static_cast<qsizetype>(view.size())));
+		} else if constexpr (std::same_as<type, QByteArray>) {
+			// An ArrayBuffer that shares the data of the QByteArray, it is not
+			// copied
+			return jsEngine->toScriptValue(std::forward<T>(value));
+		} else if constexpr (detail::byte_range<type>) {
+			// QJSEngine cannot adopt foreign memory, the bytes are copied once
+			return jsEngine->toScriptValue(
+			    QByteArray(reinterpret_cast<const char*>(std::ranges::data(value)),
+			               static_cast<qsizetype>(std::ranges::size(value))));
+		} else if constexpr (std::same_as<type, bool>) {
+			return QJSValue(value);
+		} else if constexpr (std::integral<type>) {
+			if constexpr (sizeof(type) < sizeof(int) ||
+			              (sizeof(type) == sizeof(int) && std::is_signed_v<type>)) {
+				return QJSValue(static_cast<int>(value));
+			} else if constexpr (sizeof(type) == sizeof(uint)) {
+				return QJSValue(static_cast<uint>(value));
+			} else {
+				return QJSValue(static_cast<double>(value));
+			}
+		} else if constexpr (std::floating_point<type>) {
+			return QJSValue(static_cast<double>(value));
+		} else if constexpr (std::same_as<type, std::exception_ptr>) {
+			try {
+				std::rethrow_exception(value);
+			} catch (const std::exception& e) {
+				return (*this)(jsEngine, e.what());
+			} catch (...) {
+			}
+			return QJSValue::UndefinedValue;
+		} else if constexpr (std::same_as<type, std::monostate> ||
+		                     std::same_as<type, std::nullopt_t>) {
+			return QJSValue::UndefinedValue;
+		} else if constexpr (detail::optional_like<type>) {
+			if (!value.has_value()) {
+				return QJSValue::NullValue;
+			}
+			return (*this)(jsEngine, *std::forward<T>(value));
+		} else if constexpr (requires { std::variant_size<type>::value; }) {
+			return std::visit(
+			    [&](auto&& alternative) {
+				    return (*this)(jsEngine,
+				                   std::forward<decltype(alternative)>(alternative));
+			    },
+			    std::forward<T>(value));
+		} else if constexpr (detail::map_like<type>) {
+			auto object = jsEngine->newObject();
+			if constexpr (detail::qt_map<type>) {
+				for (auto it = value.constBegin(); it != value.constEnd(); ++it) {
+					// QJsonObject returns a reference wrapper, not the value
+					const typename type::mapped_type& mapped = it.value();
+					object.setProperty(detail::script_key_name(it.key()),
+					                   (*this)(jsEngine, mapped));
+				}
+			} else {
+				for (auto&& [key, mapped] : value) {
+					object.setProperty(
+					    detail::script_key_name(key),
+					    element(jsEngine, std::forward<T>(value), mapped));
+				}
+			}
+			return object;
+		} else if constexpr (detail::typed_array_range<type>) {
+			// Copied into an ArrayBuffer with a single memcpy, the elements are
+			// not converted one by one. QJSEngine cannot adopt foreign memory,
+			// so this copy remains even for an rvalue.
+			using element_type =
+			    std::remove_cv_t<std::ranges::range_value_t<type>>;
+			const auto bytes = std::as_bytes(std::span(std::ranges::data(value),
+			                                           std::ranges::size(value)));
+			const auto buffer = jsEngine->toScriptValue(
+			    QByteArray(reinterpret_cast<const char*>(bytes.data()),
+			               static_cast<qsizetype>(bytes.size())));
+			return detail::typedArrayConstructor<element_type>(jsEngine)
+			    .callAsConstructor({buffer});
+		} else if constexpr (std::ranges::input_range<type>) {
+			auto    array = jsEngine->newArray();
+			quint32 index = 0;
+			for (auto&& item : value) {
+				array.setProperty(index++,
+				                  element(jsEngine, std::forward<T>(value), item));
+			}
+			return array;
+		} else if constexpr (detail::tuple_like<type>) {
+			return std::apply(
+			    [&](auto&&... members) {
+				    return make_array(
+				        jsEngine,
+				        element(jsEngine, std::forward<T>(value), members)...);
+			    },
+			    value);
+		} else if constexpr (detail::has_script_fields<type>) {
+			const auto& names  = detail::script_field_names<type>();
+			auto        object = jsEngine->newObject();
+			std::apply(
+			    [&](const auto&... fields) {
+				    std::size_t index = 0;
+				    (object.setProperty(names[index++],
+				                        element(jsEngine, std::forward<T>(value),
+				                                value.*(fields.member))),
+				     ...);
+			    },
+			    script_fields<type>::value);
+			return object;
+		} else if constexpr (std::is_aggregate_v<type>) {
+			return std::apply(
+			    [&](auto&... members) {
+				    return make_array(
+				        jsEngine,
+				        element(jsEngine, std::forward<T>(value), members)...);
+			    },
+			    detail::tie_aggregate(value));
+		} else {
+			return jsEngine->toScriptValue(value);
+		}
+	}
+
+private:
+	// Converts a part of a value, it is moved if the value is an rvalue
+	template <class Whole, class Part>
+	auto element(QJSEngine* const jsEngine, Whole&& /*whole*/,
+	             Part& part) const -> QJSValue {
+		if constexpr (std::is_rvalue_reference_v<Whole&&> &&
+		              !std::is_const_v<Part>) {
+			return (*this)(jsEngine, std::move(part));
+		} else {
+			return (*this)(jsEngine, std::as_const(part));
+		}
+	}
+
+	template <class... Values>
+	static auto make_array(QJSEngine* const jsEngine, Values&&... values)
+	    -> QJSValue {
+		auto    array = jsEngine->newArray(static_cast<uint>(sizeof...(values)));
+		quint32 index = 0;
+		(array.setProperty(index++, std::forward<Values>(values)), ...);
+		return array;
+	}
+};
+
+inline constexpr to_script_value_t to_script_value{};
+
+namespace detail {
+template <class... Args>
+auto toValueList(QJSEngine* const jsEngine, Args&&... args) -> QJSValueList {
+	QJSValueList list;
+	list.reserve(sizeof...(args));
+	(list.append(to_script_value(jsEngine, std::forward<Args>(args))), ...);
+	return list;
+}
+} // namespace detail
+
+} // namespace stdexecutils::qt
+
+#endif // STDEXEC_UTILS_SCRIPT_VALUE_HPP
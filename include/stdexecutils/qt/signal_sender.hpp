@@ -0,0 +1,430 @@
+#ifndef STDEXEC_UTILS_SIGNAL_SENDER_HPP
+#define STDEXEC_UTILS_SIGNAL_SENDER_HPP
+
+#include <stdexecutils/qt/detail/object_operation.hpp>
+
+#include <QObject>
+#include <QThread>
+
+#ifndef Q_MOC_RUN
+#include <exec/sequence_senders.hpp>
+#include <stdexec/execution.hpp>
+#endif
+
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace stdexecutils::qt {
+namespace detail {
+
+template <class T>
+void accept_implicitly(T);
+
+// Private signals, like QTimer::timeout, end with a QPrivateSignal argument.
+// The tag is an empty struct with an explicit default constructor, so unlike
+// other empty types it can't be initialized from {}.
+template <class T>
+concept private_signal_tag =
+    std::is_empty_v<T> && !requires { accept_implicitly<T>({}); };
+
+template <class... Args>
+constexpr auto ends_with_private_signal_tag() -> bool {
+	if constexpr (sizeof...(Args) == 0) {
+		return false;
+	} else {
+		return private_signal_tag<std::decay_t<
+		    std::tuple_element_t<sizeof...(Args) - 1, std::tuple<Args...>>>>;
+	}
+}
+
+template <class Tuple, class Indices>
+struct tuple_prefix;
+
+template <class Tuple, std::size_t... Indices>
+struct tuple_prefix<Tuple, std::index_sequence<Indices...>> {
+	using type = std::tuple<std::tuple_element_t<Indices, Tuple>...>;
+};
+
+template <class Signal>
+struct signal_traits;
+
+template <class Class, class... Args>
+struct signal_traits<void (Class::*)(Args...)> {
+	using object_type = Class;
+	// The decayed arguments, without the tag of private signals
+	using values_type = typename tuple_prefix<
+	    std::tuple<std::decay_t<Args>...>,
+	    std::make_index_sequence<sizeof...(Args) -
+	                             (ends_with_private_signal_tag<Args...>() ? 1
+	                                                                      : 0)>>::
+	    type;
+};
+
+// Connection of an operation state to a signal and to the destroyed signal of
+// its object, see object_operation. Derived handles the events in
+// on_signal(), on_destroyed() and on_cancel().
+template <class Derived, class Recv, class Object, class Signal, class... Values>
+class signal_connection
+    : public object_operation<
+          signal_connection<Derived, Recv, Object, Signal, Values...>, Recv,
+          Object, 1> {
+	using base = object_operation<signal_connection, Recv, Object, 1>;
+
+public:
+	signal_connection(Recv&& receiver, Object* object, Signal signal)
+	    : base(std::move(receiver), object), m_signal(signal) {}
+
+private:
+	friend base;
+
+	auto on_connect() -> bool {
+		auto& self = static_cast<Derived&>(*this);
+		this->connect_signal(m_signal, [&self](const Values&... values) {
+			self.on_signal(values...);
+		});
+		return true;
+	}
+
+	void on_destroyed() noexcept { static_cast<Derived&>(*this).on_destroyed(); }
+
+	void on_cancel() noexcept { static_cast<Derived&>(*this).on_cancel(); }
+
+	const Signal m_signal;
+};
+
+template <class... Values>
+inline constexpr bool nothrow_copyable =
+    (std::is_nothrow_copy_constructible_v<Values> && ...);
+
+// Operation state of signal_sender, it completes with the first emission
+template <class Recv, class Object, class Signal, class... Values>
+class signal_op_state
+    : public signal_connection<signal_op_state<Recv, Object, Signal, Values...>,
+                               Recv, Object, Signal, Values...> {
+	using base = signal_connection<signal_op_state, Recv, Object, Signal,
+	                               Values...>;
+
+public:
+	using base::base;
+
+private:
+	friend base;
+
+	void on_signal(const Values&... values) noexcept {
+		if (!this->disconnect()) {
+			return;
+		}
+		// The arguments are copied, they belong to the emitter
+		if constexpr (nothrow_copyable<Values...>) {
+			stdexec::set_value(std::move(this->m_receiver), Values(values)...);
+		} else {
+			try {
+				stdexec::set_value(std::move(this->m_receiver), Values(values)...);
+			} catch (...) {
+				stdexec::set_error(std::move(this->m_receiver),
+				                   std::current_exception());
+			}
+		}
+	}
+
+	void on_destroyed() noexcept {
+		if (this->disconnect()) {
+			stdexec::set_stopped(std::move(this->m_receiver));
+		}
+	}
+
+	void on_cancel() noexcept {
+		stdexec::set_stopped(std::move(this->m_receiver));
+	}
+};
+
+template <class Object, class Signal, class Values>
+struct signal_emission_sender;
+
+template <class Object, class Signal, class... Values>
+struct signal_emission_sender<Object, Signal, std::tuple<Values...>> {
+	using __id = signal_emission_sender;
+	using __t  = signal_emission_sender;
+
+	using sender_concept        = stdexec::sender_t;
+	using completion_signatures = stdexec::completion_signatures< //
+	    stdexec::set_value_t(Values...),                          //
+	    stdexec::set_error_t(std::exception_ptr),                 //
+	    stdexec::set_stopped_t()>;
+
+	signal_emission_sender(Object* object, Signal signal) noexcept
+	    : m_object(object), m_signal(signal) {}
+
+	template <class R>
+	auto connect(R r) const -> signal_op_state<R, Object, Signal, Values...> {
+		return signal_op_state<R, Object, Signal, Values...>(std::move(r),
+		                                                     m_object, m_signal);
+	}
+
+	auto get_env() const noexcept -> stdexec::empty_env { return {}; }
+
+private:
+	Object* m_object;
+	Signal  m_signal;
+};
+
+// Operation state of signal_sequence. Every emission is an item, only one is
+// handed to the receiver at a time. Emissions while the receiver is busy with
+// an item are coalesced, the latest one is delivered next.
+template <class Recv, class Object, class Signal, class... Values>
+class signal_sequence_op_state
+    : public signal_connection<
+          signal_sequence_op_state<Recv, Object, Signal, Values...>, Recv,
+          Object, Signal, Values...> {
+	using base = signal_connection<signal_sequence_op_state, Recv, Object,
+	                               Signal, Values...>;
+
+public:
+	using item_sender = decltype(stdexec::just(std::declval<Values>()...));
+
+	using base::base;
+
+private:
+	friend base;
+
+	enum class ending { done, failed, stopped };
+
+	struct item_receiver {
+		using __id = item_receiver;
+		using __t  = item_receiver;
+
+		using receiver_concept = stdexec::receiver_t;
+
+		void set_value() noexcept { m_opState->item_done(false); }
+
+		// The receiver can't take more items, the sequence ends
+		template <class Error>
+		void set_error(Error&& /*error*/) noexcept {
+			m_opState->item_done(true);
+		}
+
+		void set_stopped() noexcept { m_opState->item_done(true); }
+
+		[[nodiscard]] auto get_env() const noexcept -> stdexec::env_of_t<Recv> {
+			return stdexec::get_env(m_opState->m_receiver);
+		}
+
+		signal_sequence_op_state* m_opState;
+	};
+
+	using next_sender = decltype(exec::set_next(std::declval<Recv&>(),
+	                                            std::declval<item_sender>()));
+	using item_op_state = stdexec::connect_result_t<next_sender, item_receiver>;
+
+	void on_signal(const Values&... values) noexcept {
+		try {
+			if (m_itemActive) {
+				m_pending.emplace(values...);
+				return;
+			}
+			start_item(values...);
+		} catch (...) {
+			fail(std::current_exception());
+			return;
+		}
+		if (m_itemFinished) {
+			next_item();
+		}
+	}
+
+	void on_destroyed() noexcept {
+		if (this->disconnect()) {
+			end(ending::done);
+		}
+	}
+
+	void on_cancel() noexcept { end(ending::stopped); }
+
+	// An item that completes before start() returned, e.g. because its handler
+	// emitted the signal again, is only recorded. The caller continues with
+	// next_item() afterwards, the operation state isn't replaced below its own
+	// start().
+	template <class... Args>
+	void start_item(Args&&... values) {
+		m_item.emplace(stdexec::__conv{[&]() {
+			return stdexec::connect(
+			    exec::set_next(this->m_receiver,
+			                   stdexec::just(std::forward<Args>(values)...)),
+			    item_receiver{this});
+		}});
+		m_itemActive = true;
+		m_starting   = true;
+		stdexec::start(*m_item);
+		m_starting = false;
+	}
+
+	// Called from any thread when the receiver is done with an item
+	void item_done(bool stopped) noexcept {
+		m_itemStopped = stopped;
+		if (QThread::currentThread() != this->context()->thread()) {
+			this->context()->push(&m_itemDoneTask);
+		} else if (m_starting) {
+			m_itemFinished = true;
+		} else {
+			next_item();
+		}
+	}
+
+	static void on_item_done(run_queue_task* itemDoneTask,
+	                         bool            stopped) noexcept {
+		auto& self = static_cast<signal_sequence_op_state&>(
+		    static_cast<typename base::task*>(itemDoneTask)->op_state);
+		self.m_itemStopped = self.m_itemStopped || stopped;
+		self.next_item();
+	}
+
+	// Loops while the items complete inline, instead of recursing
+	void next_item() noexcept {
+		do {
+			m_itemActive   = false;
+			m_itemFinished = false;
+			if (m_ending.has_value()) {
+				complete();
+				return;
+			}
+			if (m_itemStopped) {
+				if (this->disconnect()) {
+					end(stdexec::get_stop_token(stdexec::get_env(this->m_receiver))
+					            .stop_requested()
+					        ? ending::stopped
+					        : ending::done);
+				}
+				return;
+			}
+			if (!m_pending.has_value()) {
+				return;
+			}
+			auto values = std::move(*m_pending);
+			m_pending.reset();
+			try {
+				std::apply(
+				    [this](Values&... pending) {
+					    start_item(std::move(pending)...);
+				    },
+				    values);
+			} catch (...) {
+				fail(std::current_exception());
+				return;
+			}
+		} while (m_itemFinished);
+	}
+
+	void fail(std::exception_ptr error) noexcept {
+		if (this->disconnect()) {
+			m_error = std::move(error);
+			end(ending::failed);
+		}
+	}
+
+	// Completes once the item that is handed to the receiver is done
+	void end(ending result) noexcept {
+		m_pending.reset();
+		m_ending = result;
+		if (!m_itemActive) {
+			complete();
+		}
+	}
+
+	void complete() noexcept {
+		m_item.reset();
+		switch (*m_ending) {
+		case ending::done:
+			stdexec::set_value(std::move(this->m_receiver));
+			break;
+		case ending::failed:
+			stdexec::set_error(std::move(this->m_receiver), std::move(m_error));
+			break;
+		case ending::stopped:
+			stdexec::set_stopped(std::move(this->m_receiver));
+			break;
+		}
+	}
+
+	std::optional<item_op_state>         m_item;
+	std::optional<std::tuple<Values...>> m_pending;
+	typename base::task                  m_itemDoneTask{*this, &on_item_done};
+	bool                                 m_itemActive{false};
+	bool                                 m_itemStopped{false};
+	bool                                 m_starting{false};
+	bool                                 m_itemFinished{false};
+	std::optional<ending>                m_ending;
+	std::exception_ptr                   m_error;
+};
+
+template <class Object, class Signal, class Values>
+struct signal_sequence_sender;
+
+template <class Object, class Signal, class... Values>
+struct signal_sequence_sender<Object, Signal, std::tuple<Values...>> {
+	using __id = signal_sequence_sender;
+	using __t  = signal_sequence_sender;
+
+	using sender_concept        = exec::sequence_sender_t;
+	using completion_signatures = stdexec::completion_signatures< //
+	    stdexec::set_value_t(),                                   //
+	    stdexec::set_error_t(std::exception_ptr),                 //
+	    stdexec::set_stopped_t()>;
+	using item_types =
+	    exec::item_types<decltype(stdexec::just(std::declval<Values>()...))>;
+
+	signal_sequence_sender(Object* object, Signal signal) noexcept
+	    : m_object(object), m_signal(signal) {}
+
+	template <class R>
+	friend auto tag_invoke(exec::subscribe_t, signal_sequence_sender self, R r)
+	    -> signal_sequence_op_state<R, Object, Signal, Values...> {
+		return signal_sequence_op_state<R, Object, Signal, Values...>(
+		    std::move(r), self.m_object, self.m_signal);
+	}
+
+	auto get_env() const noexcept -> stdexec::empty_env { return {}; }
+
+private:
+	Object* m_object;
+	Signal  m_signal;
+};
+} // namespace detail
+
+// Sender that completes with the arguments of the next emission of a signal,
+// e.g. signal_sender(timer, &QTimer::timeout). It completes with set_stopped
+// when stop is requested or when the object is destroyed first.
+//
+// The signal must be emitted on the thread of the object, the sender
+// completes there. Qt allocates the records of the connections, the
+// operation state holds everything else. A failed allocation, or an argument
+// that throws when copied, completes it with set_error.
+template <std::derived_from<QObject> Object, class Signal>
+    requires std::derived_from<
+        Object, typename detail::signal_traits<Signal>::object_type>
+auto signal_sender(Object* object, Signal signal) {
+	return detail::signal_emission_sender<
+	    Object, Signal, typename detail::signal_traits<Signal>::values_type>(
+	    object, signal);
+}
+
+// Sequence sender with an item for every emission of a signal. It completes
+// with set_value when the object is destroyed, and with set_stopped when
+// stop is requested. Emissions that arrive while the receiver is still busy
+// with an item are coalesced to the latest one.
+template <std::derived_from<QObject> Object, class Signal>
+    requires std::derived_from<
+        Object, typename detail::signal_traits<Signal>::object_type>
+auto signal_sequence(Object* object, Signal signal) {
+	return detail::signal_sequence_sender<
+	    Object, Signal, typename detail::signal_traits<Signal>::values_type>(
+	    object, signal);
+}
+
+} // namespace stdexecutils::qt
+
+#endif // STDEXEC_UTILS_SIGNAL_SENDER_HPP
@@ -0,0 +1,117 @@
+#ifndef STDEXEC_UTILS_TRACING_HPP
+#define STDEXEC_UTILS_TRACING_HPP
+
+#include <stdexecutils/qt/queries.hpp>
+
+#include <QString>
+
+#include <cstdint>
+
+class QIODevice;
+
+// Tracing of the operations of the Qt schedulers. It is compiled in with the
+// ENABLE_TRACING CMake option, which defines STDEXECUTILS_QT_TRACING; without
+// it the hooks compile to nothing and the functions below do nothing.
+//
+// Every thread records into its own lock-free ring buffer, the oldest events
+// are overwritten when it is full. Operations are labelled with the
+// get_trace_label query of their environment, e.g.
+//
+//   stdexec::write_env(stdexec::schedule(scheduler),
+//                      stdexec::prop{get_trace_label, "load model"})
+namespace stdexecutils::qt::tracing {
+
+enum class event_kind : std::uint8_t {
+	enqueue,  // The operation was queued, or its timer armed
+	start,    // A thread took it and runs its completion
+	complete, // The completion returned
+};
+
+#ifdef STDEXECUTILS_QT_TRACING
+inline constexpr bool enabled = true;
+
+// Recording is on from the start. Turning it off keeps the recorded events.
+void set_recording(bool recording) noexcept;
+
+[[nodiscard]] auto is_recording() noexcept -> bool;
+
+// Appends an event to the buffer of the calling thread. The operation is only
+// used as an identifier. The event is dropped if the first event of a thread
+// can't allocate its buffer.
+void record(event_kind kind, const void* operation, const char* label) noexcept;
+
+// Drops the recorded events of all threads
+void clear() noexcept;
+
+// Writes the recorded events in the Chrome trace event format, which
+// chrome://tracing and the Perfetto UI open. The queued time of an operation
+// is an async slice, the completion a slice on the thread that ran it.
+auto write_chrome_trace(QIODevice& device) -> bool;
+
+auto write_chrome_trace(const QString& fileName) -> bool;
+#else
+inline constexpr bool enabled = false;
+
+inline void set_recording(bool /*recording*/) noexcept {}
+
+[[nodiscard]] inline auto is_recording() noexcept -> bool { return false; }
+
+inline void record(event_kind /*kind*/, const void* /*operation*/,
+                   const char* /*label*/) noexcept {}
+
+inline void clear() noexcept {}
+
+inline auto write_chrome_trace(QIODevice& /*device*/) -> bool { return false; }
+
+inline auto write_chrome_trace(const QString& /*fileName*/) -> bool {
+	return false;
+}
+#endif
+
+} // namespace stdexecutils::qt::tracing
+
+namespace stdexecutils::qt::detail {
+
+// Records that an operation was queued, with the label of its environment
+template <class Env>
+inline void trace_enqueue([[maybe_unused]] const void* operation,
+                          [[maybe_unused]] const Env& env) noexcept {
+#ifdef STDEXECUTILS_QT_TRACING
+	tracing::record(tracing::event_kind::enqueue, operation,
+	                get_trace_label(env));
+#endif
+}
+
+// Records the start and the end of a completion. Only the address of the
+// operation is kept, it may be destroyed by the completion.
+#ifdef STDEXECUTILS_QT_TRACING
+class trace_run {
+public:
+	explicit trace_run(const void* operation) noexcept
+	    : m_operation(operation) {
+		tracing::record(tracing::event_kind::start, m_operation, nullptr);
+	}
+
+	trace_run(const trace_run&) = delete;
+	trace_run(trace_run&&)      = delete;
+
+	~trace_run() {
+		tracing::record(tracing::event_kind::complete, m_operation, nullptr);
+	}
+
+private:
+	const void* const m_operation;
+};
+#else
+class trace_run {
+public:
+	explicit trace_run(const void* /*operation*/) noexcept {}
+
+	trace_run(const trace_run&) = delete;
+	trace_run(trace_run&&)      = delete;
+};
+#endif
+
+} // namespace stdexecutils::qt::detail
+
+#endif // STDEXEC_UTILS_TRACING_HPP
@@ -16,6 +16,7 @@ void QmlReceiver::registerMetatype(const char* moduleUri /*= "QmlReceiver"*/,
 
 void QmlReceiver::then(QJSValue valueFunction, QJSValue failedFunction /*= {}*/,
                        QJSValue stoppedFunction /*= {}*/) {
+	m_handlersAttached = true;
 	if (valueFunction.isCallable()) {
 		m_onValue = valueFunction;
 	}
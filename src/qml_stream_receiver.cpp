@@ -0,0 +1,291 @@
+#include <stdexecutils/qt/qml_stream_receiver.hpp>
+
+#include <QTimerEvent>
+#include <QtQml>
+
+#include <algorithm>
+
+namespace stdexecutils::qt {
+
+QmlStreamReceiver::~QmlStreamReceiver() {
+	requestStop();
+	// Waits until a producer or completion that is inside the object is done,
+	// the sequence does not reach the object afterwards
+	m_link->detach();
+
+	while (auto* const item = m_items.pop_front()) {
+		item->m_destroy(item);
+	}
+	if (m_error != nullptr) {
+		m_error->m_destroy(m_error);
+	}
+}
+
+void QmlStreamReceiver::registerMetatype(
+    const char* moduleUri /*= "QmlStreamReceiver"*/,
+    int moduleVersionMajor /*=1*/, int moduleVersionMinor /*= 0*/) {
+	qmlRegisterUncreatableType<QmlStreamReceiver>(
+	    moduleUri, moduleVersionMajor, moduleVersionMinor, "QmlStreamReceiver",
+	    "sequence senders can only be launched in C++");
+
+	qRegisterMetaType<QmlStreamReceiver*>("QmlStreamReceiver*");
+}
+
+void QmlStreamReceiver::subscribe(QJSValue nextFunction,
+                                  QJSValue doneFunction /*= {}*/,
+                                  QJSValue failedFunction /*= {}*/,
+                                  QJSValue stoppedFunction /*= {}*/) {
+	if (nextFunction.isCallable()) {
+		m_onNext = nextFunction;
+	}
+	if (doneFunction.isCallable()) {
+		m_onDone = doneFunction;
+	}
+	if (failedFunction.isCallable()) {
+		m_onError = failedFunction;
+	}
+	if (stoppedFunction.isCallable()) {
+		m_onStopped = stoppedFunction;
+	}
+}
+
+void QmlStreamReceiver::requestStop() noexcept {
+	m_link->request_stop();
+
+	// Parked producers are released, their items are dropped
+	detail::stream_waiter* waiters = nullptr;
+	{
+		const std::lock_guard lock(m_mutex);
+		waiters       = m_waitersHead;
+		m_waitersHead = nullptr;
+		m_waitersTail = nullptr;
+	}
+	while (waiters != nullptr) {
+		auto* const next = waiters->m_next;
+		waiters->m_item->m_destroy(waiters->m_item);
+		waiters->m_resume(waiters, true);
+		waiters = next;
+	}
+}
+
+void QmlStreamReceiver::timerEvent(QTimerEvent* event) {
+	if (event->timerId() != m_intervalTimer.timerId()) {
+		QObject::timerEvent(event);
+		return;
+	}
+	m_intervalTimer.stop();
+	deliver();
+}
+
+auto QmlStreamReceiver::push(detail::stream_waiter* waiter) noexcept
+    -> push_result {
+	detail::stream_item* replaced = nullptr;
+	auto                 result   = push_result::queued;
+	bool                 schedule = false;
+	{
+		const std::lock_guard lock(m_mutex);
+		if (m_link->stop_requested()) {
+			result = push_result::stopped;
+		} else if (m_policy.mode == Coalescing::LatestOnly) {
+			replaced = m_items.pop_front();
+			m_items.push_back(waiter->m_item);
+		} else if (m_items.m_size >= m_policy.capacity) {
+			// Resumed by the delivery that makes room
+			result = push_result::parked;
+			if (m_waitersTail != nullptr) {
+				m_waitersTail->m_next = waiter;
+			} else {
+				m_waitersHead = waiter;
+			}
+			m_waitersTail  = waiter;
+			waiter->m_next = nullptr;
+		} else {
+			m_items.push_back(waiter->m_item);
+		}
+		if (result == push_result::queued && !m_deliveryScheduled) {
+			m_deliveryScheduled = true;
+			schedule            = true;
+		}
+	}
+	if (replaced != nullptr) {
+		replaced->m_destroy(replaced);
+	}
+	if (result == push_result::stopped) {
+		waiter->m_item->m_destroy(waiter->m_item);
+	}
+	if (schedule) {
+		schedule_delivery();
+	}
+	return result;
+}
+
+void QmlStreamReceiver::finish(completion result,
+                               detail::stream_item* error) noexcept {
+	bool schedule = false;
+	{
+		const std::lock_guard lock(m_mutex);
+		m_completion = result;
+		m_error      = error;
+		if (!m_deliveryScheduled) {
+			m_deliveryScheduled = true;
+			schedule            = true;
+		}
+	}
+	if (schedule) {
+		schedule_delivery();
+	}
+}
+
+void QmlStreamReceiver::schedule_delivery() noexcept {
+	QMetaObject::invokeMethod(
+	    this, [this]() { deliver(); }, Qt::QueuedConnection);
+}
+
+void QmlStreamReceiver::deliver() {
+	const auto now = std::chrono::steady_clock::now();
+	if (const auto next = m_lastDelivery + m_policy.interval; now < next) {
+		// Coalesces everything that arrives until the interval passed
+		if (!m_intervalTimer.isActive()) {
+			m_intervalTimer.start(
+			    std::chrono::ceil<std::chrono::milliseconds>(next - now),
+			    Qt::PreciseTimer, this);
+		}
+		return;
+	}
+
+	item_queue             items;
+	detail::stream_waiter* resumed = nullptr;
+	auto                   result  = completion::none;
+	detail::stream_item*   error   = nullptr;
+	bool                   more    = false;
+	{
+		const std::lock_guard lock(m_mutex);
+		const auto            count =
+		    m_policy.mode == Coalescing::MaxPerTick
+		        ? std::min(m_items.m_size,
+		                   std::max<std::size_t>(m_policy.maxPerTick, 1))
+		        : m_items.m_size;
+		for (std::size_t i = 0; i < count; ++i) {
+			items.push_back(m_items.pop_front());
+		}
+		// Parked producers whose items fit now are queued and resumed
+		while (m_waitersHead != nullptr && m_items.m_size < m_policy.capacity) {
+			auto* const waiter = m_waitersHead;
+			m_waitersHead      = waiter->m_next;
+			m_items.push_back(waiter->m_item);
+			waiter->m_next = resumed;
+			resumed        = waiter;
+		}
+		if (m_waitersHead == nullptr) {
+			m_waitersTail = nullptr;
+		}
+		more = m_items.m_size > 0;
+		if (!more) {
+			result       = m_completion;
+			error        = m_error;
+			m_completion = completion::none;
+			m_error      = nullptr;
+		}
+		m_deliveryScheduled = more;
+	}
+	if (more) {
+		schedule_delivery();
+	}
+	// Out of order resumption is fine, their items are queued in order already
+	while (resumed != nullptr) {
+		auto* const next = resumed->m_next;
+		resumed->m_resume(resumed, false);
+		resumed = next;
+	}
+
+	m_lastDelivery       = now;
+	auto* const jsEngine = qjsEngine(this);
+	if (m_policy.mode == Coalescing::Batch && items.m_size > 0) {
+		auto    batch = jsEngine->newArray(static_cast<uint>(items.m_size));
+		quint32 index = 0;
+		while (auto* const item = items.pop_front()) {
+			auto values = item->m_convert(item, jsEngine);
+			item->m_destroy(item);
+			if (values.size() == 1) {
+				batch.setProperty(index++, values.front());
+				continue;
+			}
+			auto tuple = jsEngine->newArray(static_cast<uint>(values.size()));
+			for (qsizetype i = 0; i < values.size(); ++i) {
+				tuple.setProperty(static_cast<quint32>(i), values[i]);
+			}
+			batch.setProperty(index++, tuple);
+		}
+		if (m_onNext.isCallable()) {
+			m_onNext.call({batch});
+		}
+	} else {
+		// With LatestOnly the queue holds a single item
+		while (auto* const item = items.pop_front()) {
+			call_next(jsEngine, item);
+		}
+	}
+
+	if (result == completion::none || m_finished) {
+		return;
+	}
+	m_finished = true;
+	switch (result) {
+	case completion::done:
+		if (m_onDone.isCallable()) {
+			m_onDone.call();
+		}
+		break;
+	case completion::failed:
+		if (m_onError.isCallable()) {
+			m_onError.call(error != nullptr ? error->m_convert(error, jsEngine)
+			                                : QJSValueList{});
+		}
+		break;
+	case completion::stopped:
+		if (m_onStopped.isCallable()) {
+			m_onStopped.call();
+		}
+		break;
+	case completion::none:
+		break;
+	}
+	if (error != nullptr) {
+		error->m_destroy(error);
+	}
+}
+
+void QmlStreamReceiver::call_next(QJSEngine* jsEngine,
+                                  detail::stream_item* item) {
+	auto values = item->m_convert(item, jsEngine);
+	item->m_destroy(item);
+	if (m_onNext.isCallable()) {
+		m_onNext.call(values);
+	}
+}
+
+void QmlStreamReceiver::item_queue::push_back(
+    detail::stream_item* item) noexcept {
+	item->m_next = nullptr;
+	if (m_tail != nullptr) {
+		m_tail->m_next = item;
+	} else {
+		m_head = item;
+	}
+	m_tail = item;
+	++m_size;
+}
+
+auto QmlStreamReceiver::item_queue::pop_front() noexcept
+    -> detail::stream_item* {
+	auto* const item = m_head;
+	if (item != nullptr) {
+		m_head = item->m_next;
+		if (m_head == nullptr) {
+			m_tail = nullptr;
+		}
+		--m_size;
+	}
+	return item;
+}
+} // namespace stdexecutils::qt
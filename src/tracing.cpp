@@ -0,0 +1,343 @@
+#include <stdexecutils/qt/tracing.hpp>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#endif
+
+namespace stdexecutils::qt::tracing {
+namespace {
+
+struct event {
+	std::int64_t timestamp; // Nanoseconds of the steady clock
+	const void*  operation;
+	const char*  label;
+	event_kind   kind;
+	int          thread;
+};
+
+// Ring buffer of one thread. Only that thread pushes, readers copy it without
+// locking and drop the slots that were overwritten while they copied them.
+// The buffer is handed to a new thread once its thread finished, the events
+// of the previous one are kept until they are overwritten.
+class trace_buffer {
+public:
+	static constexpr std::size_t capacity = std::size_t{1} << 15;
+
+	trace_buffer() : m_slots(std::make_unique<slot[]>(capacity)) {}
+
+	// Called by the thread that records into the buffer from now on
+	void assign(int thread) noexcept { m_thread = thread; }
+
+	void push(event_kind kind, const void* operation, const char* label,
+	          std::int64_t timestamp) noexcept {
+		const auto position = m_written.load(std::memory_order_relaxed);
+		auto&      slot     = m_slots[position % capacity];
+		// A sequence of 0 marks the slot as being written
+		slot.sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.timestamp.store(timestamp, std::memory_order_relaxed);
+		slot.operation.store(operation, std::memory_order_relaxed);
+		slot.label.store(label, std::memory_order_relaxed);
+		slot.kind.store(kind, std::memory_order_relaxed);
+		slot.thread.store(m_thread, std::memory_order_relaxed);
+		slot.sequence.store(position + 1, std::memory_order_release);
+		m_written.store(position + 1, std::memory_order_release);
+	}
+
+	void collect(std::vector<event>& events) const {
+		const auto written = m_written.load(std::memory_order_acquire);
+		auto       position = std::max(m_begin.load(std::memory_order_relaxed),
+		                               written > capacity ? written - capacity : 0);
+		for (; position < written; ++position) {
+			const auto& slot     = m_slots[position % capacity];
+			const auto  sequence = position + 1;
+			if (slot.sequence.load(std::memory_order_acquire) != sequence) {
+				continue;
+			}
+			const event copy{slot.timestamp.load(std::memory_order_relaxed),
+			                 slot.operation.load(std::memory_order_relaxed),
+			                 slot.label.load(std::memory_order_relaxed),
+			                 slot.kind.load(std::memory_order_relaxed),
+			                 slot.thread.load(std::memory_order_relaxed)};
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+				events.push_back(copy);
+			}
+		}
+	}
+
+	void clear() noexcept {
+		m_begin.store(m_written.load(std::memory_order_acquire),
+		              std::memory_order_relaxed);
+	}
+
+private:
+	struct slot {
+		std::atomic<std::uint64_t> sequence{0};
+		std::atomic<std::int64_t>  timestamp{0};
+		std::atomic<const void*>   operation{nullptr};
+		std::atomic<const char*>   label{nullptr};
+		std::atomic<event_kind>    kind{event_kind::enqueue};
+		std::atomic<int>           thread{0};
+	};
+
+	int                        m_thread{0};
+	std::unique_ptr<slot[]>    m_slots;
+	std::atomic<std::uint64_t> m_written{0};
+	std::atomic<std::uint64_t> m_begin{0};
+};
+
+// Buffers outlive their threads, so a trace can be written after the threads
+// recorded into it have finished. There are at most as many buffers as
+// threads recording at the same time, finished threads return theirs.
+struct registry {
+	std::mutex                                 mutex;
+	std::vector<std::unique_ptr<trace_buffer>> buffers;
+	std::vector<trace_buffer*>                 freeBuffers;
+	// Names of all threads that recorded, indexed by thread number - 1
+	std::vector<QString> threadNames;
+	std::atomic<bool>    recording{true};
+
+	// Not destroyed, threads may still record during static destruction
+	static auto instance() -> registry& {
+		static auto* const instance = new registry;
+		return *instance;
+	}
+
+	// Leaves the registry unchanged if an allocation fails
+	auto add_thread() -> trace_buffer* {
+		const std::lock_guard lock(mutex);
+		const auto            thread = static_cast<int>(threadNames.size()) + 1;
+		auto                  name   = current_thread_name(thread);
+		reserve_one(threadNames);
+		std::unique_ptr<trace_buffer> created;
+		if (freeBuffers.empty()) {
+			created = std::make_unique<trace_buffer>();
+			reserve_one(buffers);
+			// So release() doesn't allocate when the thread finishes
+			freeBuffers.reserve(buffers.capacity());
+		}
+		threadNames.push_back(std::move(name));
+		trace_buffer* buffer = nullptr;
+		if (created) {
+			buffer = buffers.emplace_back(std::move(created)).get();
+		} else {
+			buffer = freeBuffers.back();
+			freeBuffers.pop_back();
+		}
+		buffer->assign(thread);
+		return buffer;
+	}
+
+	void release(trace_buffer* buffer) noexcept {
+		const std::lock_guard lock(mutex);
+		freeBuffers.push_back(buffer);
+	}
+
+	// Name of the calling thread. QThread::currentThread() would adopt threads
+	// that Qt didn't start, so the native name is used, which QThread sets to
+	// its object name.
+	static auto current_thread_name(int thread) -> QString {
+#ifdef Q_OS_LINUX
+		std::array<char, 16> name{};
+		if (pthread_getname_np(pthread_self(), name.data(), name.size()) == 0 &&
+		    name[0] != '\0') {
+			return QString::fromLocal8Bit(name.data());
+		}
+#endif
+		return QStringLiteral("Thread %1").arg(thread);
+	}
+
+	template <class T>
+	static void reserve_one(std::vector<T>& vector) {
+		if (vector.size() == vector.capacity()) {
+			vector.reserve(std::max<std::size_t>(vector.size() * 2, 8));
+		}
+	}
+};
+
+// Returns the buffer to the registry when the thread finishes
+struct thread_buffer {
+	thread_buffer() : buffer(registry::instance().add_thread()) {}
+
+	thread_buffer(const thread_buffer&) = delete;
+	thread_buffer(thread_buffer&&)      = delete;
+
+	~thread_buffer();
+
+	trace_buffer* const buffer;
+};
+
+// Trivially destructible, still valid while the other thread_locals of the
+// thread are destroyed
+thread_local bool threadFinished = false;
+
+thread_buffer::~thread_buffer() {
+	threadFinished = true;
+	registry::instance().release(buffer);
+}
+
+// Returns nullptr once the thread is finishing, its buffer may already belong
+// to another thread then, or if its buffer couldn't be allocated
+auto current_buffer() noexcept -> trace_buffer* {
+	if (threadFinished) {
+		return nullptr;
+	}
+	try {
+		thread_local thread_buffer threadBuffer;
+		return threadBuffer.buffer;
+	} catch (...) {
+		// The event is dropped, the next one tries again
+		return nullptr;
+	}
+}
+
+auto to_id(const void* operation) -> QString {
+	return QStringLiteral("0x%1").arg(reinterpret_cast<quintptr>(operation), 0,
+	                                  16);
+}
+
+auto to_microseconds(std::int64_t nanoseconds) -> double {
+	return static_cast<double>(nanoseconds) / 1000.0;
+}
+} // namespace
+
+void set_recording(bool recording) noexcept {
+	registry::instance().recording.store(recording, std::memory_order_relaxed);
+}
+
+auto is_recording() noexcept -> bool {
+	return registry::instance().recording.load(std::memory_order_relaxed);
+}
+
+void record(event_kind kind, const void* operation, const char* label) noexcept {
+	if (!is_recording()) {
+		return;
+	}
+	const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+	                           std::chrono::steady_clock::now().time_since_epoch())
+	                           .count();
+	if (auto* const buffer = current_buffer()) {
+		buffer->push(kind, operation, label, timestamp);
+	}
+}
+
+void clear() noexcept {
+	auto&                 instance = registry::instance();
+	const std::lock_guard lock(instance.mutex);
+	for (const auto& buffer : instance.buffers) {
+		buffer->clear();
+	}
+}
+
+auto write_chrome_trace(QIODevice& device) -> bool {
+	if (!device.isOpen() && !device.open(QIODevice::WriteOnly)) {
+		return false;
+	}
+
+	const auto pid   = QCoreApplication::applicationPid();
+	bool       first = true;
+	const auto write = [&](const QJsonObject& object) {
+		if (!first) {
+			device.write(",\n");
+		}
+		first = false;
+		device.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+	};
+	device.write("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+	std::vector<event> events;
+	{
+		auto&                 instance = registry::instance();
+		const std::lock_guard lock(instance.mutex);
+		for (const auto& buffer : instance.buffers) {
+			buffer->collect(events);
+		}
+		for (std::size_t i = 0; i < instance.threadNames.size(); ++i) {
+			write(QJsonObject{
+			    {"name", "thread_name"},
+			    {"ph", "M"},
+			    {"pid", pid},
+			    {"tid", static_cast<int>(i) + 1},
+			    {"args", QJsonObject{{"name", instance.threadNames[i]}}},
+			});
+		}
+	}
+	std::stable_sort(events.begin(), events.end(),
+	                 [](const event& lhs, const event& rhs) {
+		                 return lhs.timestamp < rhs.timestamp;
+	                 });
+
+	// Start and complete events carry no label, it is taken from the enqueue
+	// event of the operation
+	std::unordered_map<const void*, QString> labels;
+	std::unordered_map<const void*, bool>    queued;
+	for (const auto& event : events) {
+		QJsonObject object{{"pid", pid},
+		                   {"tid", event.thread},
+		                   {"ts", to_microseconds(event.timestamp)}};
+		switch (event.kind) {
+		case event_kind::enqueue: {
+			auto& label = labels[event.operation];
+			label       = event.label != nullptr ? QString::fromUtf8(event.label)
+			                                     : QStringLiteral("operation");
+			queued[event.operation] = true;
+			object.insert("name", label);
+			object.insert("cat", "queued");
+			object.insert("ph", "b");
+			object.insert("id", to_id(event.operation));
+			break;
+		}
+		case event_kind::start: {
+			const auto found = labels.find(event.operation);
+			const auto label = found != labels.end() ? found->second
+			                                         : QStringLiteral("operation");
+			if (std::exchange(queued[event.operation], false)) {
+				auto queuedEnd = object;
+				queuedEnd.insert("name", label);
+				queuedEnd.insert("cat", "queued");
+				queuedEnd.insert("ph", "e");
+				queuedEnd.insert("id", to_id(event.operation));
+				write(queuedEnd);
+			}
+			object.insert("name", label);
+			object.insert("cat", "run");
+			object.insert("ph", "B");
+			break;
+		}
+		case event_kind::complete:
+			object.insert("ph", "E");
+			break;
+		}
+		write(object);
+	}
+	device.write("\n]}\n");
+	return true;
+}
+
+auto write_chrome_trace(const QString& fileName) -> bool {
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		return false;
+	}
+	return write_chrome_trace(static_cast<QIODevice&>(file));
+}
+
+} // namespace stdexecutils::qt::tracing
@@ -1,6 +1,8 @@
 #include <stdexecutils/qt/qml_receiver.hpp>
+#include <stdexecutils/qt/qml_stream_receiver.hpp>
 
 #ifndef Q_MOC_RUN
+#include <exec/sequence/iterate.hpp>
 #include <exec/task.hpp>
 #endif
 
@@ -8,10 +10,36 @@
 
 #include <QCoreApplication>
 #include <QJSEngine>
+#include <QJsonObject>
+#include <QVariantMap>
 #include <QtQml>
 
+#include <map>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
 using namespace stdexecutils::qt;
 
+struct Point {
+	int    x;
+	double y;
+};
+
+template <>
+struct stdexecutils::qt::script_fields<Point> {
+	static constexpr auto value =
+	    std::tuple{script_field{"x", &Point::x}, script_field{"y", &Point::y}};
+};
+
+struct Sample {
+	std::string name;
+	int         value;
+};
+
 class LaunchFunctions : public QObject {
 	Q_OBJECT
 public:
@@ -36,6 +64,54 @@ public:
 	Q_INVOKABLE QmlReceiver* startStopped() {
 		return new QmlReceiver(stdexec::just_stopped());
 	}
+	Q_INVOKABLE QmlReceiver* startFloatVector() {
+		return new QmlReceiver(stdexec::just(std::vector<float>{1.5F, 2.5F, 3.5F}));
+	}
+	Q_INVOKABLE QmlReceiver* startByteArray() {
+		return new QmlReceiver(stdexec::just(QByteArray("abcd")));
+	}
+	Q_INVOKABLE QmlReceiver* startByteVector() {
+		return new QmlReceiver(
+		    stdexec::just(std::vector<std::byte>(3, std::byte{0x2a})));
+	}
+	Q_INVOKABLE QmlStreamReceiver* startBatchedStream() {
+		return new QmlStreamReceiver(
+		    exec::iterate(std::views::iota(0, 100)),
+		    {QmlStreamReceiver::Coalescing::Batch, 1, 1024,
+		     std::chrono::milliseconds{0}});
+	}
+	Q_INVOKABLE QmlStreamReceiver* startZeroCapacityStream() {
+		return new QmlStreamReceiver(
+		    exec::iterate(std::views::iota(0, 100)),
+		    {QmlStreamReceiver::Coalescing::Batch, 1, 0,
+		     std::chrono::milliseconds{0}});
+	}
+	Q_INVOKABLE QmlStreamReceiver* startLatestStream() {
+		return new QmlStreamReceiver(exec::iterate(std::views::iota(0, 100)));
+	}
+	Q_INVOKABLE QmlReceiver* startManual(bool immediate) {
+		if (immediate) {
+			return new QmlReceiver(QmlReceiver::immediate_completion,
+			                       stdexec::schedule(m_loop.get_scheduler()));
+		}
+		return new QmlReceiver(stdexec::schedule(m_loop.get_scheduler()));
+	}
+	// Completes the receivers of startManual on this thread
+	Q_INVOKABLE void completeManual() {
+		m_loop.finish();
+		m_loop.run();
+	}
+	Q_INVOKABLE QmlReceiver* startStructured() {
+		return new QmlReceiver(stdexec::just(
+		    Point{1, 2.5}, Sample{"a", 3},
+		    std::map<std::string, std::vector<std::string>>{{"key", {"v"}}},
+		    std::optional<int>{}, std::variant<int, std::string>{"alt"}));
+	}
+	Q_INVOKABLE QmlReceiver* startQtMaps() {
+		return new QmlReceiver(stdexec::just(
+		    QVariantMap{{"name", "a"}, {"count", 3}},
+		    QJsonObject{{"flag", true}}));
+	}
 	Q_INVOKABLE QmlReceiver* startDelay() {
 		return new QmlReceiver(QThreadScheduler(this).schedule_after(std::chrono::seconds(1)));
 	}
@@ -47,6 +123,9 @@ public slots:
 	void failure() { //
 		FAIL();
 	}
+
+private:
+	stdexec::run_loop m_loop;
 };
 static int argc = 0;
 class QMLTestFixture : public testing::Test {
@@ -54,6 +133,7 @@ public:
 	QMLTestFixture() : application(argc, nullptr), engine(&application) {
 
 		QmlReceiver::registerMetatype("TestModule", 1, 0);
+		QmlStreamReceiver::registerMetatype("TestModule", 1, 0);
 		auto type2 = qmlRegisterUncreatableType<LaunchFunctions>("TestModule", 1, 0,
 		                                                         "Functions", "is created in C++");
 		auto functions = new LaunchFunctions();
@@ -116,6 +196,179 @@ TEST_F(QMLTestFixture, twoValuesResult) {
 	application.exec();
 }
 
+TEST_F(QMLTestFixture, floatVectorResult) {
+	const auto result = engine.evaluate(R"(
+  (function() {
+      functions.startFloatVector().then((result) => {
+          functions.success(result instanceof Float32Array &&
+                            result.length === 3 && result[1] === 2.5);
+      }, () => {
+          functions.failure();
+      }, () => {
+          functions.failure();
+      });
+  })()
+)");
+	ASSERT_FALSE(result.isError());
+
+	application.exec();
+}
+
+TEST_F(QMLTestFixture, byteVectorResult) {
+	const auto result = engine.evaluate(R"(
+  (function() {
+      functions.startByteVector().then((result) => {
+          functions.success(result instanceof ArrayBuffer &&
+                            new Uint8Array(result)[2] === 42);
+      }, () => {
+          functions.failure();
+      }, () => {
+          functions.failure();
+      });
+  })()
+)");
+	ASSERT_FALSE(result.isError());
+
+	application.exec();
+}
+
+TEST_F(QMLTestFixture, byteArrayResult) {
+	const auto result = engine.evaluate(R"(
+  (function() {
+      functions.startByteArray().then((result) => {
+          functions.success(result instanceof ArrayBuffer &&
+                            result.byteLength === 4);
+      }, () => {
+          functions.failure();
+      }, () => {
+          functions.failure();
+      });
+  })()
+)");
+	ASSERT_FALSE(result.isError());
+
+	application.exec();
+}
+
+TEST_F(QMLTestFixture, batchedStream) {
+	const auto result = engine.evaluate(R"(
+  (function() {
+      let count = 0;
+      functions.startBatchedStream().subscribe((batch) => {
+          count += batch.length;
+      }, () => {
+          functions.success(count === 100);
+      }, () => {
+          functions.failure();
+      }, () => {
+          functions.failure();
+      });
+  })()
+)");
+	ASSERT_FALSE(result.isError());
+
+	application.exec();
+}
+
+TEST_F(QMLTestFixture, zeroCapacityStream) {
+	const auto result = engine.evaluate(R"(
+  (function() {
+      let count = 0;
+      functions.startZeroCapacityStream().subscribe((batch) => {
+          count += batch.length;
+      }, () => {
+          functions.success(count === 100);
+      }, () => {
+          functions.failure();
+      }, () => {
+          functions.failure();
+      });
+  })()
+)");
+	ASSERT_FALSE(result.isError());
+
+	application.exec();
+}
+
+TEST_F(QMLTestFixture, latestOnlyStream) {
+	const auto result = engine.evaluate(R"(
+  (function() {
+      let calls = 0;
+      let last = -1;
+      functions.startLatestStream().subscribe((value) => {
+          ++calls;
+          last = value;
+      }, () => {
+          functions.success(calls === 1 && last === 99);
+      }, () => {
+          functions.failure();
+      }, () => {
+          functions.failure();
+      });
+  })()
+)");
+	ASSERT_FALSE(result.isError());
+
+	application.exec();
+}
+
+TEST_F(QMLTestFixture, immediateCompletion) {
+	const auto result = engine.evaluate(R"(
+  (function() {
+      let immediate = false;
+      let completed = false;
+      functions.startManual(true).then(() => { immediate = true; });
+      functions.startManual(false).then(() => {
+          // Runs after the script, the immediate one ran inside completeManual
+          functions.success(immediate && completed);
+      });
+      functions.completeManual();
+      completed = immediate;
+  })()
+)");
+	ASSERT_FALSE(result.isError());
+
+	application.exec();
+}
+
+TEST_F(QMLTestFixture, structuredResult) {
+	const auto result = engine.evaluate(R"(
+  (function() {
+      functions.startStructured().then((point, sample, map, optional, variant) => {
+          functions.success(point.x === 1 && point.y === 2.5 &&
+                            sample[0] === "a" && sample[1] === 3 &&
+                            map.key[0] === "v" && optional === null &&
+                            variant === "alt");
+      }, () => {
+          functions.failure();
+      }, () => {
+          functions.failure();
+      });
+  })()
+)");
+	ASSERT_FALSE(result.isError());
+
+	application.exec();
+}
+
+TEST_F(QMLTestFixture, qtMapResult) {
+	const auto result = engine.evaluate(R"(
+  (function() {
+      functions.startQtMaps().then((variantMap, jsonObject) => {
+          functions.success(variantMap.name === "a" && variantMap.count === 3 &&
+                            jsonObject.flag === true);
+      }, () => {
+          functions.failure();
+      }, () => {
+          functions.failure();
+      });
+  })()
+)");
+	ASSERT_FALSE(result.isError());
+
+	application.exec();
+}
+
 TEST_F(QMLTestFixture, errorTest) {
 	const auto result = engine.evaluate(R"(
 	(function() {
@@ -166,4 +419,97 @@ TEST_F(QMLTestFixture, requestStopTest) {
 	application.exec();
 }
 
+namespace {
+template <class T>
+struct counting_allocator {
+	using value_type = T;
+
+	explicit counting_allocator(int* allocations, int* deallocations) noexcept
+	    : allocations(allocations), deallocations(deallocations) {}
+
+	template <class U>
+	counting_allocator(const counting_allocator<U>& other) noexcept
+	    : allocations(other.allocations), deallocations(other.deallocations) {}
+
+	auto allocate(std::size_t n) -> T* {
+		++*allocations;
+		return std::allocator<T>{}.allocate(n);
+	}
+
+	void deallocate(T* pointer, std::size_t n) noexcept {
+		++*deallocations;
+		std::allocator<T>{}.deallocate(pointer, n);
+	}
+
+	template <class U>
+	auto operator==(const counting_allocator<U>& other) const noexcept -> bool {
+		return allocations == other.allocations;
+	}
+
+	int* allocations;
+	int* deallocations;
+};
+
+struct throwing_sender {
+	using sender_concept = stdexec::sender_t;
+	using completion_signatures =
+	    stdexec::completion_signatures<stdexec::set_value_t()>;
+
+	struct op_state {
+		void start() & noexcept {}
+	};
+
+	template <class Receiver>
+	auto connect(Receiver /*receiver*/) const -> op_state {
+		throw std::runtime_error("connect failed");
+	}
+};
+} // namespace
+
+TEST_F(QMLTestFixture, allocatorFromEnv) {
+	int allocations   = 0;
+	int deallocations = 0;
+
+	const QmlReceiver receiver(
+	    stdexec::just(42),
+	    stdexec::prop{stdexec::get_allocator,
+	                  counting_allocator<std::byte>(&allocations, &deallocations)});
+	// just completes inline, the operation state is already released
+	EXPECT_EQ(allocations, 1);
+	EXPECT_EQ(deallocations, 1);
+}
+
+TEST_F(QMLTestFixture, throwingConnectReleasesOpState) {
+	int allocations   = 0;
+	int deallocations = 0;
+
+	EXPECT_THROW(QmlReceiver(throwing_sender{},
+	                         stdexec::prop{stdexec::get_allocator,
+	                                       counting_allocator<std::byte>(
+	                                           &allocations, &deallocations)}),
+	             std::runtime_error);
+	EXPECT_EQ(allocations, 1);
+	EXPECT_EQ(deallocations, 1);
+}
+
+TEST_F(QMLTestFixture, destroyStreamWithParkedProducer) {
+	int allocations   = 0;
+	int deallocations = 0;
+
+	// The first item fills the queue, the producer of the second one parks
+	auto* const streamReceiver = new QmlStreamReceiver(
+	    exec::iterate(std::views::iota(0, 100)),
+	    {QmlStreamReceiver::Coalescing::Batch, 1, 1, std::chrono::milliseconds{0}},
+	    stdexec::prop{stdexec::get_allocator,
+	                  counting_allocator<std::byte>(&allocations, &deallocations)});
+	EXPECT_EQ(allocations, 1);
+	EXPECT_EQ(deallocations, 0);
+
+	// The parked producer is resumed as stopped and the sequence completes,
+	// the scheduled delivery is dropped with the object
+	delete streamReceiver;
+	EXPECT_EQ(deallocations, 1);
+	QCoreApplication::processEvents();
+}
+
 #include "stdexecutils_qml_tests.moc"
@@ -1,11 +1,44 @@
+#include <QBuffer>
 #include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPromise>
+#include <QTemporaryFile>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
 #include <exec/async_scope.hpp>
+#include <exec/sequence/ignore_all_values.hpp>
+#include <exec/sequence/transform_each.hpp>
+#include <exec/task.hpp>
+#include <exec/timed_scheduler.hpp>
 #include <exec/timed_thread_scheduler.hpp>
 #include <exec/when_any.hpp>
 #include <gtest/gtest.h>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <stdexecutils/qt/bounded_scheduler.hpp>
+#include <stdexecutils/qt/mapped_file.hpp>
+#include <stdexecutils/qt/qfuture.hpp>
+#include <stdexecutils/qt/qiodevice.hpp>
+#include <stdexecutils/qt/qobject_scope.hpp>
+#include <stdexecutils/qt/qthread_group.hpp>
 #include <stdexecutils/qt/qthread_scheduler.hpp>
 #include <stdexecutils/qt/qthreadpool_scheduler.hpp>
+#include <stdexecutils/qt/signal_sender.hpp>
+#include <stdexecutils/qt/tracing.hpp>
 #include <thread>
+#include <vector>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#endif
 
 using namespace stdexecutils::qt;
 
@@ -13,6 +46,13 @@ using namespace std::chrono_literals;
 
 static_assert(stdexec::scheduler<QThreadScheduler>,
               "scheduler is not fulfilling the concept");
+static_assert(exec::timed_scheduler<QThreadScheduler>,
+              "scheduler is not fulfilling the timed scheduler concept");
+static_assert(stdexec::scheduler<QThreadGroupScheduler>,
+              "scheduler is not fulfilling the concept");
+static_assert(
+    exec::timed_scheduler<decltype(qthread_scheduler())>,
+    "threadpool scheduler is not fulfilling the timed scheduler concept");
 
 TEST(QThreadScheduler, BasicSchedulingContinuation) {
 	int              argc = 0;
@@ -68,6 +108,110 @@ TEST(QThreadScheduler, BasicSchedulingStopped) {
 	application.exec();
 }
 
+TEST(QThreadScheduler, BurstRunsInOrder) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler scheduler(&application);
+
+	constexpr std::size_t    count = 1000;
+	std::vector<std::size_t> order;
+	exec::async_scope        scope;
+	for (std::size_t i = 0; i < count; ++i) {
+		scope.spawn(stdexec::schedule(scheduler) | stdexec::then([&, i]() {
+			            order.push_back(i);
+			            if (order.size() == count) {
+				            application.exit();
+			            }
+		            }));
+	}
+	application.exec();
+
+	ASSERT_EQ(order.size(), count);
+	for (std::size_t i = 0; i < count; ++i) {
+		EXPECT_EQ(order[i], i);
+	}
+}
+
+TEST(QThreadScheduler, Metrics) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler scheduler(&application);
+	scheduler.enable_metrics();
+
+	constexpr std::size_t count = 100;
+	std::size_t           ran   = 0;
+	exec::async_scope     scope;
+	for (std::size_t i = 0; i < count; ++i) {
+		scope.spawn(stdexec::schedule(scheduler) | stdexec::then([&]() {
+			            if (++ran == count) {
+				            application.exit();
+			            }
+		            }));
+	}
+	EXPECT_GE(scheduler.metrics().pending, static_cast<std::int64_t>(count));
+	application.exec();
+
+	const auto metrics = scheduler.metrics();
+	EXPECT_EQ(metrics.pending, 0);
+	EXPECT_GE(metrics.peakPending, static_cast<std::int64_t>(count));
+	EXPECT_GE(metrics.delay.count(), count);
+	EXPECT_LE(metrics.delay.percentile(0.5), metrics.delay.percentile(0.99));
+	EXPECT_LE(metrics.delay.percentile(0.99), metrics.delay.max());
+}
+
+TEST(QThreadScheduler, OutOfRangePriorities) {
+	QThread thread;
+	thread.start();
+
+	// Clamped into the high and low queues, which drain with their own priority
+	for (const int priority : {10, -10}) {
+		const QThreadScheduler scheduler(&thread,
+		                                 static_cast<Qt::EventPriority>(priority));
+		const auto result = stdexec::sync_wait(
+		    stdexec::schedule(scheduler) |
+		    stdexec::then([]() { return QThread::currentThread(); }));
+		ASSERT_TRUE(result.has_value());
+		EXPECT_EQ(std::get<0>(*result), &thread);
+	}
+
+	thread.quit();
+	thread.wait();
+}
+
+TEST(QThreadScheduler, ScheduleFromManyThreads) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler scheduler(&application);
+
+	constexpr int     producers = 4;
+	constexpr int     perThread = 1000;
+	const auto        tid       = std::this_thread::get_id();
+	int               completed = 0;
+	exec::async_scope scope;
+
+	std::vector<std::thread> threads;
+	for (int p = 0; p < producers; ++p) {
+		threads.emplace_back([&]() {
+			for (int i = 0; i < perThread; ++i) {
+				scope.spawn(stdexec::schedule(scheduler) | stdexec::then([&]() {
+					            EXPECT_EQ(tid, std::this_thread::get_id());
+					            if (++completed == producers * perThread) {
+						            application.exit();
+					            }
+				            }));
+			}
+		});
+	}
+	application.exec();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	EXPECT_EQ(completed, producers * perThread);
+}
+
 TEST(QThreadScheduler, ScheduleAt) {
 
 	int              argc = 0;
@@ -219,6 +363,272 @@ TEST(QThreadScheduler, StoppedWhenThreadStopped) {
 	EXPECT_TRUE(std::get<0>(*result));
 }
 
+TEST(QThreadScheduler, ScheduleAtSteadyClock) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler scheduler(&application);
+
+	constexpr auto duration = 200ms;
+	const auto     deadline = scheduler.now() + duration;
+
+	exec::async_scope scope;
+	scope.spawn(exec::schedule_at(scheduler, deadline) | stdexec::then([&]() {
+		            EXPECT_GE(scheduler.now(), deadline);
+		            application.exit();
+	            }));
+	application.exec();
+}
+
+TEST(QThreadScheduler, PreciseTimer) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler scheduler(&application, Qt::PreciseTimer);
+	EXPECT_EQ(scheduler.timer_type(), Qt::PreciseTimer);
+
+	const auto        start = scheduler.now();
+	exec::async_scope scope;
+	scope.spawn(exec::schedule_after(scheduler, 1500us) | stdexec::then([&]() {
+		            // Sub-millisecond delays are rounded up, never truncated
+		            EXPECT_GE(scheduler.now() - start, 1500us);
+		            application.exit();
+	            }));
+	application.exec();
+}
+
+TEST(QThreadScheduler, HighPriorityRunsFirst) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler low(&application, Qt::LowEventPriority);
+	QThreadScheduler high(&application, Qt::HighEventPriority);
+	EXPECT_EQ(get_priority(low), Qt::LowEventPriority);
+	EXPECT_EQ(get_priority(stdexec::get_env(stdexec::schedule(high))),
+	          Qt::HighEventPriority);
+
+	std::vector<int>  order;
+	exec::async_scope scope;
+	scope.spawn(stdexec::schedule(low) | stdexec::then([&]() {
+		            order.push_back(Qt::LowEventPriority);
+		            application.exit();
+	            }));
+	scope.spawn(stdexec::schedule(high) |
+	            stdexec::then([&]() { order.push_back(Qt::HighEventPriority); }));
+	application.exec();
+
+	EXPECT_EQ(order, (std::vector<int>{Qt::HighEventPriority,
+	                                   Qt::LowEventPriority}));
+}
+
+TEST(QThreadScheduler, ManyTimeouts) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler scheduler(&application);
+
+	constexpr int     count   = 10000;
+	int               fired   = 0;
+	int               stopped = 0;
+	exec::async_scope scope;
+	exec::async_scope cancelledScope;
+	for (int i = 0; i < count; ++i) {
+		scope.spawn(scheduler.schedule_after(std::chrono::milliseconds(i % 50)) |
+		            stdexec::then([&]() { ++fired; }));
+		cancelledScope.spawn(scheduler.schedule_after(10s) |
+		                     stdexec::upon_stopped([&]() { ++stopped; }));
+	}
+	scope.spawn(scheduler.schedule_after(100ms) | stdexec::then([&]() {
+		            cancelledScope.request_stop();
+	            }));
+	scope.spawn(scheduler.schedule_after(200ms) |
+	            stdexec::then([&]() { application.exit(); }));
+	application.exec();
+
+	EXPECT_EQ(fired, count);
+	EXPECT_EQ(stopped, count);
+}
+
+TEST(QThreadScheduler, ScheduleAfterFromOtherThread) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler scheduler(&application);
+
+	const auto        tid = std::this_thread::get_id();
+	const auto        now = std::chrono::steady_clock::now();
+	exec::async_scope scope;
+	std::thread       producer([&]() {
+		scope.spawn(scheduler.schedule_after(100ms) | stdexec::then([&]() {
+			            EXPECT_EQ(tid, std::this_thread::get_id());
+			            EXPECT_GE(std::chrono::steady_clock::now() - now, 100ms);
+			            application.exit();
+		            }));
+	});
+	application.exec();
+	producer.join();
+}
+
+TEST(QThreadScheduler, EventfdWakeup) {
+	QThread thread;
+	thread.start();
+	if (!QThreadScheduler::enable_eventfd_wakeup(&thread)) {
+		thread.quit();
+		thread.wait();
+		GTEST_SKIP() << "eventfd wakeup is not supported";
+	}
+	const QThreadScheduler scheduler(&thread);
+	// The switch is done on the thread, before this task
+	stdexec::sync_wait(stdexec::schedule(scheduler));
+	EXPECT_TRUE(scheduler.eventfd_wakeup());
+
+	std::atomic<int>  count{0};
+	exec::async_scope scope;
+	for (int i = 0; i < 1000; ++i) {
+		scope.spawn(stdexec::schedule(scheduler) | stdexec::then([&]() {
+			            EXPECT_EQ(QThread::currentThread(), &thread);
+			            ++count;
+		            }));
+	}
+	stdexec::sync_wait(scope.on_empty());
+	EXPECT_EQ(count.load(), 1000);
+	EXPECT_TRUE(
+	    stdexec::sync_wait(exec::schedule_after(scheduler, 1ms)).has_value());
+
+	thread.quit();
+	thread.wait();
+}
+
+TEST(QThreadScheduler, EventfdWakeupAfterRestart) {
+	QThread thread;
+	thread.start();
+	if (!QThreadScheduler::enable_eventfd_wakeup(&thread)) {
+		thread.quit();
+		thread.wait();
+		GTEST_SKIP() << "eventfd wakeup is not supported";
+	}
+	const QThreadScheduler scheduler(&thread);
+	stdexec::sync_wait(stdexec::schedule(scheduler));
+	EXPECT_TRUE(scheduler.eventfd_wakeup());
+
+	// The thread falls back to posted events when it finishes
+	thread.quit();
+	thread.wait();
+	EXPECT_FALSE(scheduler.eventfd_wakeup());
+	thread.start();
+	const auto result = stdexec::sync_wait(
+	    stdexec::schedule(scheduler) |
+	    stdexec::then([]() { return QThread::currentThread(); }));
+	ASSERT_TRUE(result.has_value());
+	EXPECT_EQ(std::get<0>(*result), &thread);
+
+	// And the eventfd can be enabled again
+	EXPECT_TRUE(QThreadScheduler::enable_eventfd_wakeup(&thread));
+	stdexec::sync_wait(stdexec::schedule(scheduler));
+	EXPECT_TRUE(scheduler.eventfd_wakeup());
+	std::atomic<int>  count{0};
+	exec::async_scope scope;
+	for (int i = 0; i < 100; ++i) {
+		scope.spawn(stdexec::schedule(scheduler) |
+		            stdexec::then([&]() { ++count; }));
+	}
+	stdexec::sync_wait(scope.on_empty());
+	EXPECT_EQ(count.load(), 100);
+
+	thread.quit();
+	thread.wait();
+}
+
+TEST(QThreadScheduler, ContinuesOnSameThreadIsInline) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler scheduler(&application);
+
+	// Completes without running the event loop of the thread
+	const auto result = stdexec::sync_wait(stdexec::just(42) |
+	                                       stdexec::continues_on(scheduler));
+	ASSERT_TRUE(result.has_value());
+	EXPECT_EQ(std::get<0>(*result), 42);
+	EXPECT_TRUE(
+	    stdexec::sync_wait(stdexec::starts_on(scheduler, stdexec::just()))
+	        .has_value());
+}
+
+TEST(QThreadScheduler, ContinuesOnOtherThreadHops) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler scheduler(&application);
+
+	const auto        tid = std::this_thread::get_id();
+	exec::async_scope scope;
+	std::thread       producer([&]() {
+		scope.spawn(stdexec::just(42) | stdexec::continues_on(scheduler) |
+		            stdexec::then([&](int value) {
+			            EXPECT_EQ(value, 42);
+			            EXPECT_EQ(tid, std::this_thread::get_id());
+			            application.exit();
+		            }));
+	});
+	application.exec();
+	producer.join();
+}
+
+TEST(QThreadScheduler, TaskAwaitOnSameThreadIsInline) {
+	QThread thread;
+	thread.start();
+	const QThreadScheduler scheduler(&thread);
+
+	auto task = [&]() -> exec::task<bool> {
+		co_await scheduler.schedule();
+		// The sender completes on the scheduler of the task, the task resumes
+		// inline instead of hopping through the type-erased scheduler
+		co_await (scheduler.schedule() | stdexec::then([]() {}));
+		co_return detail::inline_depth() > 0;
+	};
+	const auto result =
+	    stdexec::sync_wait(stdexec::starts_on(scheduler, task()));
+	ASSERT_TRUE(result.has_value());
+	EXPECT_TRUE(std::get<0>(*result));
+
+	thread.quit();
+	thread.wait();
+}
+
+namespace {
+struct test_timer : detail::timer_node {
+	explicit test_timer(std::vector<std::uint64_t>& fired) noexcept
+	    : detail::timer_node(&on_fire), fired(&fired) {}
+
+	static void on_fire(detail::timer_node* node, bool /*stopped*/) noexcept {
+		auto* const self = static_cast<test_timer*>(node);
+		self->fired->push_back(self->id);
+	}
+
+	std::vector<std::uint64_t>* fired;
+	std::uint64_t               id{0};
+};
+} // namespace
+
+TEST(TimerWheel, FiresInDeadlineOrder) {
+	std::vector<std::uint64_t> fired;
+	detail::timer_wheel        wheel;
+	std::vector<test_timer>    timers(5000, test_timer{fired});
+	for (std::uint64_t i = 0; i < timers.size(); ++i) {
+		// Spread the expiries over all levels of the wheel
+		timers[i].id = (i * 7919) % 20000000;
+		wheel.insert(&timers[i], timers[i].id + 1);
+	}
+	EXPECT_TRUE(wheel.remove(&timers[42]));
+	EXPECT_FALSE(wheel.remove(&timers[42]));
+
+	wheel.advance(20000001);
+	EXPECT_TRUE(wheel.empty());
+	ASSERT_EQ(fired.size(), timers.size() - 1);
+	EXPECT_TRUE(std::is_sorted(fired.begin(), fired.end()));
+}
+
 TEST(ThreadpoolScheduler, BasicWorks) {
 	QThreadPool threadpool;
 
@@ -229,6 +639,19 @@ TEST(ThreadpoolScheduler, BasicWorks) {
 	EXPECT_NE(std::get<0>(*opt_tid), std::this_thread::get_id());
 }
 
+TEST(ThreadpoolScheduler, OperationStateIsNotDeletedByPool) {
+	QThreadPool      threadpool;
+	std::atomic<int> runs{0};
+	// The operation states are the runnables, sync_wait owns them on its stack.
+	// The pool must neither delete them nor touch them after run().
+	for (int i = 0; i < 100; ++i) {
+		stdexec::sync_wait(stdexec::schedule(qthread_scheduler(&threadpool)) |
+		                   stdexec::then([&]() { ++runs; }));
+	}
+	threadpool.waitForDone();
+	EXPECT_EQ(runs.load(), 100);
+}
+
 TEST(ThreadpoolScheduler, BasicStops) {
 	exec::async_scope scope;
 	scope.request_stop();
@@ -241,3 +664,757 @@ TEST(ThreadpoolScheduler, BasicStops) {
 	stdexec::sync_wait(scope.on_empty());
 	EXPECT_TRUE(stopped);
 }
+
+TEST(ThreadpoolScheduler, StopsQueuedWork) {
+	QThreadPool pool;
+	pool.setMaxThreadCount(1);
+
+	// Occupies the only pool thread, so all scheduled work stays queued
+	std::atomic<bool> release{false};
+	pool.start([&]() {
+		while (!release) {
+			std::this_thread::yield();
+		}
+	});
+
+	constexpr int     count = 100;
+	std::atomic<int>  ran{0};
+	std::atomic<int>  stopped{0};
+	exec::async_scope scope;
+	for (int i = 0; i < count; ++i) {
+		scope.spawn(stdexec::schedule(qthread_scheduler(&pool)) |
+		            stdexec::then([&]() { ++ran; }) |
+		            stdexec::upon_stopped([&]() { ++stopped; }));
+	}
+	scope.request_stop();
+	// The queued runnables are taken out of the pool by the stop request
+	EXPECT_EQ(stopped, count);
+
+	release = true;
+	stdexec::sync_wait(scope.on_empty());
+	EXPECT_EQ(ran, 0);
+}
+
+TEST(ThreadpoolScheduler, BulkRunsInParallel) {
+	QThreadPool pool;
+	pool.setMaxThreadCount(4);
+
+	constexpr std::size_t     size = 100000;
+	std::vector<int>          values(size, 0);
+	std::mutex                mutex;
+	std::set<std::thread::id> threads;
+
+	const auto result = stdexec::sync_wait(
+	    stdexec::schedule(qthread_scheduler(&pool)) |
+	    stdexec::then([]() { return 2; }) |
+	    stdexec::bulk(size, [&](std::size_t i, int factor) {
+		    values[i] = static_cast<int>(i % 7) * factor;
+		    const std::lock_guard lock(mutex);
+		    threads.insert(std::this_thread::get_id());
+	    }));
+	ASSERT_TRUE(result.has_value());
+	EXPECT_EQ(std::get<0>(*result), 2);
+	for (std::size_t i = 0; i < size; ++i) {
+		ASSERT_EQ(values[i], static_cast<int>(i % 7) * 2);
+	}
+	EXPECT_GE(threads.size(), 1U);
+	EXPECT_LE(threads.size(), 4U);
+}
+
+TEST(ThreadpoolScheduler, BulkStartedOnPool) {
+	QThreadPool pool;
+	pool.setMaxThreadCount(1);
+
+	// Customized through the scheduler the work starts on, the calling pool
+	// thread is the only worker
+	std::vector<int> values(1000, 0);
+	auto             work =
+	    stdexec::just(3) |
+	    stdexec::bulk(values.size(),
+	                  [&](std::size_t i, int factor) { values[i] = factor; });
+	const auto result = stdexec::sync_wait(
+	    stdexec::starts_on(qthread_scheduler(&pool), std::move(work)));
+	ASSERT_TRUE(result.has_value());
+	EXPECT_EQ(std::get<0>(*result), 3);
+	EXPECT_TRUE(std::ranges::all_of(values, [](int value) { return value == 3; }));
+}
+
+TEST(ThreadpoolScheduler, BulkPropagatesErrors) {
+	QThreadPool pool;
+
+	EXPECT_THROW(stdexec::sync_wait(
+	                 stdexec::schedule(qthread_scheduler(&pool)) |
+	                 stdexec::bulk(1000,
+	                               [](std::size_t i) {
+		                               if (i == 500) {
+			                               throw std::runtime_error("bulk");
+		                               }
+	                               })),
+	             std::runtime_error);
+}
+
+TEST(ThreadpoolScheduler, Priority) {
+	QThreadPool pool;
+	const auto  scheduler = qthread_scheduler(&pool, 5);
+	EXPECT_EQ(get_priority(scheduler), 5);
+	EXPECT_EQ(get_priority(stdexec::get_env(stdexec::schedule(scheduler))), 5);
+}
+
+TEST(ThreadpoolScheduler, ScheduleAfter) {
+	QThreadPool pool;
+	const auto  scheduler = qthread_scheduler(&pool);
+
+	const auto start  = std::chrono::steady_clock::now();
+	const auto result = stdexec::sync_wait(
+	    exec::schedule_after(scheduler, 20ms) |
+	    stdexec::then([]() { return std::this_thread::get_id(); }));
+	ASSERT_TRUE(result.has_value());
+	EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+	EXPECT_NE(std::get<0>(result.value()), std::this_thread::get_id());
+}
+
+TEST(ThreadpoolScheduler, ScheduleAfterStopped) {
+	QThreadPool pool;
+	const auto  scheduler = qthread_scheduler(&pool);
+
+	constexpr int     count = 1000;
+	std::atomic<int>  ran{0};
+	std::atomic<int>  stopped{0};
+	exec::async_scope scope;
+	for (int i = 0; i < count; ++i) {
+		scope.spawn(exec::schedule_after(scheduler, 1h) |
+		            stdexec::then([&]() { ++ran; }) |
+		            stdexec::upon_stopped([&]() { ++stopped; }));
+	}
+	scope.request_stop();
+	// The timers are removed from the timer service by the stop request
+	EXPECT_EQ(stopped, count);
+	stdexec::sync_wait(scope.on_empty());
+	EXPECT_EQ(ran, 0);
+}
+
+TEST(ThreadpoolScheduler, Metrics) {
+	QThreadPool pool;
+	const auto  scheduler = qthread_scheduler(&pool);
+
+	// Nothing is recorded until the metrics are enabled
+	stdexec::sync_wait(stdexec::schedule(scheduler));
+	EXPECT_EQ(scheduler.metrics().peakPending, 0);
+	EXPECT_EQ(scheduler.metrics().delay.count(), 0U);
+
+	scheduler.enable_metrics();
+	stdexec::sync_wait(stdexec::schedule(scheduler));
+	stdexec::sync_wait(exec::schedule_after(scheduler, 5ms));
+
+	const auto metrics = scheduler.metrics();
+	EXPECT_EQ(metrics.pending, 0);
+	EXPECT_GE(metrics.peakPending, 1);
+	EXPECT_EQ(metrics.delay.count(), 2U);
+	EXPECT_EQ(metrics.timerLateness.count(), 1U);
+	// Another scheduler of the pool shares the metrics
+	EXPECT_EQ(qthread_scheduler(&pool, 1).metrics().delay.count(), 2U);
+}
+
+TEST(QThreadGroup, RunsOnGroupThreads) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadGroup group(4);
+	ASSERT_EQ(group.size(), 4U);
+
+	std::set<QThread*> groupThreads;
+	for (std::size_t i = 0; i < group.size(); ++i) {
+		groupThreads.insert(group.thread(i));
+	}
+
+	constexpr int     count = 1000;
+	std::atomic<int>  ran{0};
+	exec::async_scope scope;
+	for (int i = 0; i < count; ++i) {
+		scope.spawn(stdexec::schedule(group.get_scheduler()) |
+		            stdexec::then([&]() {
+			            EXPECT_TRUE(groupThreads.contains(QThread::currentThread()));
+			            ++ran;
+		            }));
+	}
+	stdexec::sync_wait(scope.on_empty());
+	EXPECT_EQ(ran, count);
+}
+
+TEST(QThreadGroup, IdleThreadsSteal) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadGroup group(2);
+	const auto   scheduler = group.get_scheduler();
+
+	// Work scheduled from a group thread is queued locally, it only completes
+	// while that thread is blocked if the other thread steals it
+	constexpr int     count = 100;
+	std::atomic<int>  ran{0};
+	exec::async_scope scope;
+	const auto        result = stdexec::sync_wait(
+        stdexec::schedule(scheduler) | stdexec::then([&]() {
+	        for (int i = 0; i < count; ++i) {
+		        scope.spawn(stdexec::schedule(scheduler) |
+		                    stdexec::then([&]() { ++ran; }));
+	        }
+	        const auto deadline = std::chrono::steady_clock::now() + 5s;
+	        while (ran < count && std::chrono::steady_clock::now() < deadline) {
+		        std::this_thread::yield();
+	        }
+	        return ran.load();
+        }));
+	ASSERT_TRUE(result.has_value());
+	EXPECT_EQ(std::get<0>(result.value()), count);
+	stdexec::sync_wait(scope.on_empty());
+}
+
+TEST(QThreadGroup, ScheduleOnLeastLoaded) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadGroup group(2);
+	const auto   scheduler = group.get_scheduler();
+
+	std::atomic<bool>     release{false};
+	std::atomic<QThread*> blocked{nullptr};
+	exec::async_scope     scope;
+	scope.spawn(scheduler.schedule_on_least_loaded() | stdexec::then([&]() {
+		            blocked = QThread::currentThread();
+		            while (!release) {
+			            std::this_thread::yield();
+		            }
+	            }));
+	while (blocked == nullptr) {
+		std::this_thread::yield();
+	}
+
+	// The blocked thread is loaded, the work goes to the other one
+	const auto result = stdexec::sync_wait(
+	    scheduler.schedule_on_least_loaded() |
+	    stdexec::then([]() { return QThread::currentThread(); }));
+	ASSERT_TRUE(result.has_value());
+	EXPECT_NE(std::get<0>(result.value()), blocked.load());
+
+	release = true;
+	stdexec::sync_wait(scope.on_empty());
+}
+
+TEST(SignalSender, CompletesWithArguments) {
+	QThread thread;
+	thread.start();
+	QObject object;
+	object.moveToThread(&thread);
+
+	// The sender connects on the thread of the object before the emission,
+	// both hop over in the same batch
+	const auto result = stdexec::sync_wait(stdexec::when_all(
+	    signal_sender(&object, &QObject::objectNameChanged),
+	    stdexec::schedule(QThreadScheduler(&thread)) |
+	        stdexec::then([&]() { object.setObjectName("emitted"); })));
+	ASSERT_TRUE(result.has_value());
+	EXPECT_EQ(std::get<0>(result.value()), "emitted");
+
+	thread.quit();
+	thread.wait();
+}
+
+TEST(SignalSender, StoppedWhenObjectDestroyed) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	auto              object  = std::make_unique<QObject>();
+	bool              stopped = false;
+	exec::async_scope scope;
+	scope.spawn(signal_sender(object.get(), &QObject::objectNameChanged) |
+	            stdexec::then([](const QString&) {}) |
+	            stdexec::upon_stopped([&]() { stopped = true; }));
+	EXPECT_FALSE(stopped);
+	object.reset();
+	EXPECT_TRUE(stopped);
+	stdexec::sync_wait(scope.on_empty());
+}
+
+TEST(SignalSender, StoppedAndDisconnected) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QObject           object;
+	bool              emitted = false;
+	bool              stopped = false;
+	exec::async_scope scope;
+	scope.spawn(signal_sender(&object, &QObject::objectNameChanged) |
+	            stdexec::then([&](const QString&) { emitted = true; }) |
+	            stdexec::upon_stopped([&]() { stopped = true; }));
+	scope.request_stop();
+	QCoreApplication::processEvents();
+	EXPECT_TRUE(stopped);
+
+	object.setObjectName("late");
+	EXPECT_FALSE(emitted);
+	stdexec::sync_wait(scope.on_empty());
+}
+
+TEST(SignalSender, SequenceOfEmissions) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	auto                 object = std::make_unique<QObject>();
+	std::vector<QString> names;
+	bool                 done = false;
+	exec::async_scope    scope;
+	scope.spawn(
+	    exec::ignore_all_values(exec::transform_each(
+	        signal_sequence(object.get(), &QObject::objectNameChanged),
+	        stdexec::then([&](const QString& name) { names.push_back(name); }))) |
+	    stdexec::then([&]() { done = true; }));
+
+	object->setObjectName("first");
+	object->setObjectName("second");
+	EXPECT_EQ(names, (std::vector<QString>{"first", "second"}));
+	// The sequence ends with its object
+	EXPECT_FALSE(done);
+	object.reset();
+	EXPECT_TRUE(done);
+	stdexec::sync_wait(scope.on_empty());
+}
+
+TEST(SignalSender, SequenceHandlerEmitsAgain) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	auto                 object = std::make_unique<QObject>();
+	std::vector<QString> names;
+	exec::async_scope    scope;
+	scope.spawn(exec::ignore_all_values(exec::transform_each(
+	    signal_sequence(object.get(), &QObject::objectNameChanged),
+	    stdexec::then([&](const QString& name) {
+		    names.push_back(name);
+		    // Emitted while the item that completes inline is started
+		    if (name == "first") {
+			    object->setObjectName("second");
+		    }
+	    }))));
+
+	object->setObjectName("first");
+	EXPECT_EQ(names, (std::vector<QString>{"first", "second"}));
+	object->setObjectName("third");
+	EXPECT_EQ(names, (std::vector<QString>{"first", "second", "third"}));
+	object.reset();
+	stdexec::sync_wait(scope.on_empty());
+}
+
+TEST(QFutureInterop, AsSenderCompletesWithResult) {
+	QPromise<int> promise;
+	promise.start();
+	std::thread producer([&]() {
+		std::this_thread::sleep_for(10ms);
+		promise.addResult(42);
+		promise.finish();
+	});
+	const auto result = stdexec::sync_wait(as_sender(promise.future()));
+	producer.join();
+	ASSERT_TRUE(result.has_value());
+	EXPECT_EQ(std::get<0>(result.value()), 42);
+}
+
+TEST(QFutureInterop, AsSenderPassesException) {
+	QPromise<void> promise;
+	promise.start();
+	promise.setException(std::make_exception_ptr(std::runtime_error("failed")));
+	promise.finish();
+	EXPECT_THROW(stdexec::sync_wait(as_sender(promise.future())),
+	             std::runtime_error);
+}
+
+TEST(QFutureInterop, AsSenderWithoutResultFails) {
+	QPromise<int> promise;
+	promise.start();
+	promise.finish();
+	EXPECT_THROW(stdexec::sync_wait(as_sender(promise.future())),
+	             std::runtime_error);
+}
+
+// The sender takes over the single continuation of the future
+static_assert(!std::copy_constructible<decltype(as_sender(QFuture<int>()))>);
+
+TEST(QFutureInterop, AsSenderStopCancelsFuture) {
+	QPromise<int> promise;
+	promise.start();
+	bool              stopped = false;
+	exec::async_scope scope;
+	scope.spawn(as_sender(promise.future()) | stdexec::then([](int) {}) |
+	            stdexec::upon_stopped([&]() { stopped = true; }));
+	scope.request_stop();
+	EXPECT_TRUE(promise.isCanceled());
+	// The producer notices the cancellation and finishes
+	promise.finish();
+	EXPECT_TRUE(stopped);
+	stdexec::sync_wait(scope.on_empty());
+}
+
+TEST(QFutureInterop, AsQFutureHasResult) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	auto future = as_qfuture(stdexec::just(21) |
+	                         stdexec::then([](int value) { return value * 2; }));
+	EXPECT_TRUE(future.isFinished());
+	EXPECT_EQ(future.result(), 42);
+
+	auto failed = as_qfuture(stdexec::just_error(
+	    std::make_exception_ptr(std::runtime_error("failed"))));
+	EXPECT_THROW(failed.waitForFinished(), std::runtime_error);
+	QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+TEST(QFutureInterop, AsQFutureCancelStopsSender) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler scheduler(&application);
+	auto             future = as_qfuture(exec::schedule_after(scheduler, 1h));
+	future.cancel();
+	const auto deadline = std::chrono::steady_clock::now() + 5s;
+	while (!future.isFinished() && std::chrono::steady_clock::now() < deadline) {
+		QCoreApplication::processEvents();
+	}
+	EXPECT_TRUE(future.isFinished());
+	EXPECT_TRUE(future.isCanceled());
+	QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+namespace {
+// Connected pair of local sockets on the calling thread
+struct local_socket_pair {
+	local_socket_pair() {
+		const auto name = QStringLiteral("stdexecutils-test-%1")
+		                      .arg(QCoreApplication::applicationPid());
+		QLocalServer::removeServer(name);
+		server.listen(name);
+		client.connectToServer(name);
+		client.waitForConnected();
+		server.waitForNewConnection(1000);
+		peer = server.nextPendingConnection();
+	}
+
+	QLocalServer  server;
+	QLocalSocket  client;
+	QLocalSocket* peer{nullptr};
+};
+} // namespace
+
+TEST(QIODeviceSenders, WriteAndReadExact) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+	local_socket_pair sockets;
+	ASSERT_NE(sockets.peer, nullptr);
+
+	std::vector<std::byte> data(256 * 1024);
+	for (std::size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<std::byte>(i % 251);
+	}
+	std::vector<std::byte> received(data.size());
+	exec::async_scope      scope;
+	scope.spawn(
+	    stdexec::when_all(async_write(&sockets.client, data),
+	                      async_read_exact(sockets.peer, received)) |
+	    stdexec::then([&](std::size_t written, std::size_t read) {
+		    EXPECT_EQ(written, data.size());
+		    EXPECT_EQ(read, data.size());
+		    application.exit();
+	    }));
+	application.exec();
+	EXPECT_EQ(received, data);
+}
+
+TEST(QIODeviceSenders, WriteToFile) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+	QTemporaryFile   file;
+	ASSERT_TRUE(file.open());
+
+	// A buffered QFile emits no bytesWritten, the write flushes it instead
+	const std::array<std::byte, 4> data{std::byte{'d'}, std::byte{'a'},
+	                                    std::byte{'t'}, std::byte{'a'}};
+	const auto result = stdexec::sync_wait(async_write(&file, data));
+	ASSERT_TRUE(result.has_value());
+	EXPECT_EQ(std::get<0>(*result), data.size());
+	EXPECT_EQ(file.size(), 4);
+}
+
+TEST(QIODeviceSenders, ReadSomeAtEndOfStream) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+	local_socket_pair sockets;
+	ASSERT_NE(sockets.peer, nullptr);
+
+	std::array<std::byte, 16> buffer{};
+	exec::async_scope         scope;
+	scope.spawn(async_read_some(sockets.peer, buffer) |
+	            stdexec::then([&](std::size_t read) {
+		            EXPECT_EQ(read, 0U);
+		            application.exit();
+	            }));
+	sockets.client.disconnectFromServer();
+	application.exec();
+}
+
+TEST(QIODeviceSenders, ReadStopped) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+	local_socket_pair sockets;
+	ASSERT_NE(sockets.peer, nullptr);
+
+	std::array<std::byte, 16> buffer{};
+	exec::async_scope         scope;
+	scope.spawn(async_read_exact(sockets.peer, buffer) |
+	            stdexec::then([](std::size_t) { FAIL() << "not stopped"; }) |
+	            stdexec::upon_stopped([&]() { application.exit(); }));
+	scope.request_stop();
+	application.exec();
+
+	// The read released its connections, the data stays in the socket
+	sockets.client.write("late");
+	sockets.client.flush();
+	EXPECT_TRUE(sockets.peer->waitForReadyRead(1000));
+	EXPECT_EQ(sockets.peer->bytesAvailable(), 4);
+}
+
+namespace {
+// Temporary file with size bytes of a known pattern
+auto make_pattern_file(std::size_t size) -> std::unique_ptr<QTemporaryFile> {
+	auto file = std::make_unique<QTemporaryFile>();
+	file->open();
+	QByteArray data(static_cast<qsizetype>(size), Qt::Uninitialized);
+	for (std::size_t i = 0; i < size; ++i) {
+		data[static_cast<qsizetype>(i)] = static_cast<char>(i % 251);
+	}
+	file->write(data);
+	file->flush();
+	return file;
+}
+} // namespace
+
+TEST(MappedFile, ChunksInParallel) {
+	QThreadPool pool;
+	const auto  file = make_pattern_file(10'000);
+
+	const auto* const     testThread = QThread::currentThread();
+	std::mutex            mutex;
+	std::set<std::size_t> indices;
+	std::size_t           bytes = 0;
+	auto                  chunks = exec::transform_each(
+        mapped_file_chunks(qthread_scheduler(&pool), file->fileName(), 4096),
+        stdexec::then([&](file_chunk chunk) {
+	        EXPECT_NE(QThread::currentThread(), testThread);
+	        EXPECT_EQ(chunk.offset, chunk.index * 4096);
+	        EXPECT_EQ(std::to_integer<int>(chunk.data[0]),
+	                  static_cast<int>(chunk.offset % 251));
+	        const std::lock_guard lock(mutex);
+	        indices.insert(chunk.index);
+	        bytes += chunk.data.size();
+        }));
+	const auto result =
+	    stdexec::sync_wait(exec::ignore_all_values(std::move(chunks)));
+	ASSERT_TRUE(result.has_value());
+	EXPECT_EQ(indices, (std::set<std::size_t>{0, 1, 2}));
+	EXPECT_EQ(bytes, 10'000U);
+}
+
+TEST(MappedFile, TransformIsOrdered) {
+	QThreadPool pool;
+	const auto  file = make_pattern_file(100'000);
+
+	const auto result = stdexec::sync_wait(
+	    transform_mapped_file(qthread_scheduler(&pool), file->fileName(), 1000,
+	                          [](const file_chunk& chunk) { return chunk.offset; }));
+	ASSERT_TRUE(result.has_value());
+	const auto& offsets = std::get<0>(*result);
+	ASSERT_EQ(offsets.size(), 100U);
+	for (std::size_t i = 0; i < offsets.size(); ++i) {
+		EXPECT_EQ(offsets[i], i * 1000);
+	}
+}
+
+TEST(MappedFile, MissingFileIsError) {
+	QThreadPool pool;
+	EXPECT_THROW(
+	    stdexec::sync_wait(exec::ignore_all_values(mapped_file_chunks(
+	        qthread_scheduler(&pool), QStringLiteral("/nonexistent/file"), 4096))),
+	    io_error);
+}
+
+TEST(BoundedScheduler, LimitsInFlight) {
+	QThreadPool pool;
+	pool.setMaxThreadCount(8);
+	auto scheduler = bounded(qthread_scheduler(&pool), 2);
+
+	std::atomic<int>  running{0};
+	std::atomic<int>  peak{0};
+	std::atomic<int>  done{0};
+	exec::async_scope scope;
+	for (int i = 0; i < 20; ++i) {
+		scope.spawn(stdexec::schedule(scheduler) | stdexec::then([&]() {
+			            const auto now = running.fetch_add(1) + 1;
+			            auto       seen = peak.load();
+			            while (seen < now && !peak.compare_exchange_weak(seen, now)) {
+			            }
+			            std::this_thread::sleep_for(1ms);
+			            running.fetch_sub(1);
+			            done.fetch_add(1);
+		            }));
+	}
+	stdexec::sync_wait(scope.on_empty());
+	EXPECT_EQ(done.load(), 20);
+	EXPECT_LE(peak.load(), 2);
+	EXPECT_EQ(scheduler.in_flight(), 0U);
+	EXPECT_EQ(scheduler.parked(), 0U);
+}
+
+TEST(BoundedScheduler, StopRemovesParked) {
+	QThreadPool pool;
+	auto        scheduler = bounded(qthread_scheduler(&pool), 1);
+
+	std::atomic<bool> release{false};
+	exec::async_scope scope;
+	scope.spawn(stdexec::schedule(scheduler) |
+	            stdexec::then([&]() { release.wait(false); }));
+
+	stdexec::inplace_stop_source stopSource;
+	bool                         stopped = false;
+	scope.spawn(stdexec::write_env(
+	    stdexec::schedule(scheduler) |
+	        stdexec::upon_stopped([&]() { stopped = true; }),
+	    stdexec::prop{stdexec::get_stop_token, stopSource.get_token()}));
+	EXPECT_EQ(scheduler.parked(), 1U);
+
+	// Completes right away, while the first operation still holds the slot
+	stopSource.request_stop();
+	EXPECT_TRUE(stopped);
+	EXPECT_EQ(scheduler.parked(), 0U);
+
+	release = true;
+	release.notify_one();
+	stdexec::sync_wait(scope.on_empty());
+	EXPECT_EQ(scheduler.in_flight(), 0U);
+}
+
+TEST(QObjectScope, StopsWhenObjectDestroyed) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler scheduler(&application);
+	auto             object = std::make_unique<QObject>();
+	QObjectScope     scope(object.get());
+	bool             stopped = false;
+	scope.spawn(exec::schedule_after(scheduler, 1h) |
+	            stdexec::upon_stopped([&]() noexcept { stopped = true; }));
+	EXPECT_EQ(scope.active(), 1U);
+
+	object.reset();
+	const auto deadline = std::chrono::steady_clock::now() + 5s;
+	while (!stopped && std::chrono::steady_clock::now() < deadline) {
+		QCoreApplication::processEvents();
+	}
+	EXPECT_TRUE(stopped);
+	EXPECT_EQ(scope.active(), 0U);
+}
+
+TEST(QObjectScope, DrainsAndReuses) {
+	int              argc = 0;
+	QCoreApplication application(argc, nullptr);
+
+	QThreadScheduler scheduler(&application);
+	QObject          object;
+	QObjectScope     scope(&object);
+	std::size_t      count = 0;
+	for (int round = 0; round < 2; ++round) {
+		for (int i = 0; i < 100; ++i) {
+			scope.spawn(stdexec::schedule(scheduler) |
+			            stdexec::then([&]() noexcept { ++count; }));
+		}
+		EXPECT_EQ(scope.active(), 100U);
+		while (scope.active() > 0) {
+			QCoreApplication::processEvents();
+		}
+	}
+	EXPECT_EQ(count, 200U);
+}
+
+TEST(QObjectScope, RejectsSendersThatMayFail) {
+	using scheduler_sender = QThreadScheduler::sender;
+	static_assert(detail::scope_spawnable<scheduler_sender>);
+	static_assert(!detail::scope_spawnable<decltype(stdexec::just_error(42))>);
+	// then() with a callable that may throw completes with an exception_ptr
+	static_assert(!detail::scope_spawnable<decltype(
+	                  std::declval<scheduler_sender>() | stdexec::then([]() {}))>);
+	static_assert(detail::scope_spawnable<decltype(
+	                  std::declval<scheduler_sender>() |
+	                  stdexec::then([]() noexcept {}))>);
+}
+
+TEST(Tracing, WritesChromeTrace) {
+	if (!tracing::enabled) {
+		GTEST_SKIP() << "built without ENABLE_TRACING";
+	}
+	tracing::clear();
+	QThreadPool pool;
+	stdexec::sync_wait(
+	    stdexec::write_env(stdexec::schedule(qthread_scheduler(&pool)),
+	                       stdexec::prop{get_trace_label, "traced"}));
+
+	QBuffer buffer;
+	ASSERT_TRUE(tracing::write_chrome_trace(buffer));
+	const auto events = QJsonDocument::fromJson(buffer.data())
+	                        .object()["traceEvents"]
+	                        .toArray();
+	QStringList phases;
+	for (const auto& event : events) {
+		if (event.toObject()["name"].toString() == "traced") {
+			phases << event.toObject()["ph"].toString();
+		}
+	}
+	// Queued as an async slice, then run on a pool thread
+	EXPECT_EQ(phases, (QStringList{"b", "e", "B"}));
+}
+
+TEST(Tracing, NamesThreadsNotStartedByQt) {
+	if (!tracing::enabled) {
+		GTEST_SKIP() << "built without ENABLE_TRACING";
+	}
+	tracing::clear();
+	const int operation = 0;
+	std::thread([&]() {
+#ifdef Q_OS_LINUX
+		pthread_setname_np(pthread_self(), "plain thread");
+#endif
+		tracing::record(tracing::event_kind::enqueue, &operation, "plain");
+	}).join();
+
+	QBuffer buffer;
+	ASSERT_TRUE(tracing::write_chrome_trace(buffer));
+	const auto events = QJsonDocument::fromJson(buffer.data())
+	                        .object()["traceEvents"]
+	                        .toArray();
+	int thread = 0;
+	for (const auto& event : events) {
+		if (event.toObject()["name"].toString() == "plain") {
+			thread = event.toObject()["tid"].toInt();
+		}
+	}
+	ASSERT_NE(thread, 0);
+	QString name;
+	for (const auto& event : events) {
+		if (event.toObject()["ph"].toString() == "M" &&
+		    event.toObject()["tid"].toInt() == thread) {
+			name = event.toObject()["args"].toObject()["name"].toString();
+		}
+	}
+#ifdef Q_OS_LINUX
+	EXPECT_EQ(name, "plain thread");
+#else
+	EXPECT_EQ(name, QStringLiteral("Thread %1").arg(thread));
+#endif
+}